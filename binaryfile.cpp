@@ -0,0 +1,62 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "binaryfile.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+size_t BinaryFile::align(size_t size)
+{
+  return (size + 7) & ~static_cast<size_t>(7);
+}
+
+void BinaryFile::write(std::ostream &os, const void *data, size_t size)
+{
+  static const char padding[8] = {};
+
+  os.write(static_cast<const char *>(data), size);
+  os.write(padding, align(size) - size);
+}
+
+bool BinaryFile::map(const std::string &fileName, size_t minSize, char *&data, size_t &size)
+{
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) || static_cast<size_t>(st.st_size) < minSize) {
+    ::close(fd);
+    return false;
+  }
+
+  void *memory = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (memory == MAP_FAILED)
+    return false;
+
+  data = static_cast<char *>(memory);
+  size = st.st_size;
+  return true;
+}
+
+void BinaryFile::unmap(char *data, size_t size)
+{
+  munmap(data, size);
+}
@@ -0,0 +1,77 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef BINARYFILE_H
+#define BINARYFILE_H
+
+#include <ostream>
+#include <string>
+
+/**
+ * Helpers for the binary files that are mapped in memory instead of read, like the index and the hit store. Their
+ * sections are padded to 8 bytes, so the integers in them can be used in place.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class BinaryFile final
+{
+  public:
+    /**
+     * Returns a size rounded up to the section alignment.
+     *
+     * @param size The size to be aligned.
+     *
+     * @return The aligned size.
+     *
+     */
+    static size_t align(size_t size);
+
+    /**
+     * Write a section, padded to the section alignment.
+     *
+     * @param os The stream to be written.
+     * @param data The section data.
+     * @param size The section size.
+     *
+     */
+    static void write(std::ostream &os, const void *data, size_t size);
+
+    /**
+     * Map a whole file in memory, read only.
+     *
+     * @param fileName The file name.
+     * @param minSize Smallest size of a valid file, usually the size of its header.
+     * @param data Will receive the mapped memory.
+     * @param size Will receive the file size.
+     *
+     * @return True if the file could be mapped, false if it cannot be opened, it is not a regular file, or it is
+     *         smaller than minSize.
+     *
+     */
+    static bool map(const std::string &fileName, size_t minSize, char *&data, size_t &size);
+
+    /**
+     * Release a file mapped by map.
+     *
+     * @param data The mapped memory.
+     * @param size The file size.
+     *
+     */
+    static void unmap(char *data, size_t size);
+};
+
+#endif
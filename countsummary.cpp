@@ -0,0 +1,51 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "countsummary.h"
+#include "fastaindex.h"
+
+CountSummary::CountSummary(const std::string &fileName, const std::vector<StateMachine> &patterns, bool counts) :
+  TabularSink(fileName + ".tsv", patterns), _counts(counts)
+{
+}
+
+void CountSummary::createHeader(const std::string &)
+{
+  _os << "#sequence\tlabel\tpattern\tstrand";
+  if (_counts)
+    _os << "\thits";
+  _os << '\n';
+}
+
+void CountSummary::appendGene(const std::string &geneName, const std::string &, size_t, const GeneSource &,
+  const std::vector<PositionToMark> &, const std::vector<HIT> &hit)
+{
+  const std::string id = FastaIndex::sequenceId(geneName);
+
+  for (size_t i = 0; i < hit.size();) {
+    const size_t patternId = hit[i].patternId();
+
+    size_t hits = 0;
+    for (; i < hit.size() && hit[i].patternId() == patternId; ++i)
+      ++hits;
+
+    const StateMachine &stateMachine = _patterns.at(patternId);
+    _os << id << '\t' << stateMachine.label() << '\t' << stateMachine.pattern() << '\t' << stateMachine.strand();
+    if (_counts)
+      _os << '\t' << hits;
+    _os << '\n';
+  }
+}
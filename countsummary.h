@@ -0,0 +1,59 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef COUNTSUMMARY_H
+#define COUNTSUMMARY_H
+
+#include "tabularsink.h"
+
+/**
+ * This class will create a tab separated file listing, one per line, the state machines that have enough hits on each
+ * sequence gene, optionally with their number of hits.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class CountSummary final : public TabularSink
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param fileName Output file name to be created, without the extension.
+     * @param patterns Pattern table used to find the state machine of each hit. It must outlive this object.
+     * @param counts True to write the number of hits of each state machine, false to only list them.
+     *
+     */
+    CountSummary(const std::string &fileName, const std::vector<StateMachine> &patterns, bool counts);
+
+    /**
+     * Write the column names.
+     *
+     */
+    void createHeader(const std::string &commandLine);
+
+    /**
+     * Append the state machines with hits on a sequence gene.
+     *
+     */
+    void appendGene(const std::string &geneName, const std::string &recordName, size_t offset,
+      const GeneSource &geneSource, const std::vector<PositionToMark> &positions, const std::vector<HIT> &hit);
+
+  private:
+    bool _counts;
+};
+
+#endif
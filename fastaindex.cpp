@@ -0,0 +1,206 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "fastaindex.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+bool FastaIndex::load(const std::string &indexFile)
+{
+  std::ifstream is(indexFile.c_str());
+  if (!is)
+    return false;
+
+  _entries.clear();
+  _names.clear();
+
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.empty())
+      continue;
+
+    Entry entry;
+    std::istringstream fields(line);
+    if (!std::getline(fields, entry.name, '\t') ||
+      !(fields >> entry.length >> entry.offset >> entry.lineBases >> entry.lineWidth))
+      return false;
+
+    add(entry);
+  }
+
+  return true;
+}
+
+bool FastaIndex::loadOrBuild(const std::string &geneFile, FastaReader &reader)
+{
+  if (load(geneFile + ".fai"))
+    return true;
+
+  if (!build(reader))
+    return false;
+
+  // Not being able to store the index only makes the next run slower.
+  save(geneFile + ".fai");
+  return true;
+}
+
+bool FastaIndex::save(const std::string &indexFile) const
+{
+  std::ofstream os(indexFile.c_str());
+  if (!os)
+    return false;
+
+  for (auto &entry : _entries) {
+    os << entry.name << '\t' << entry.length << '\t' << entry.offset << '\t' << entry.lineBases << '\t'
+      << entry.lineWidth << '\n';
+  }
+
+  return static_cast<bool>(os.flush());
+}
+
+bool FastaIndex::build(FastaReader &reader)
+{
+  _entries.clear();
+  _names.clear();
+
+  std::string  geneName;
+  GeneSequence rawSequence;
+  while (reader.nextRaw(geneName, rawSequence)) {
+    // Lines before the first header do not belong to a record.
+    if (geneName.empty())
+      continue;
+
+    Entry entry;
+    entry.name      = sequenceId(geneName.substr(1));
+    entry.length    = 0;
+    entry.offset    = reader.offset(rawSequence);
+    entry.lineBases = 0;
+    entry.lineWidth = 0;
+
+    // All lines must be as long as the first one, except for the last one.
+    const char *const end = rawSequence.data() + rawSequence.size();
+    const char *line      = rawSequence.data();
+    bool shortLine = false;
+    while (line < end) {
+      const char *newLine = static_cast<const char *>(memchr(line, '\n', end - line));
+      const char *lineEnd = newLine ? newLine : end;
+      const size_t width  = (newLine ? newLine + 1 : end) - line;
+      const size_t bases  = (lineEnd > line && lineEnd[-1] == '\r') ? lineEnd - line - 1 : lineEnd - line;
+
+      if (bases > 0) {
+        if (shortLine)
+          return false;
+
+        if (entry.lineBases == 0) {
+          entry.lineBases = bases;
+          entry.lineWidth = width;
+        }
+        else if (bases > entry.lineBases || (bases == entry.lineBases && width != entry.lineWidth))
+          return false;
+
+        shortLine = bases < entry.lineBases;
+      }
+      else
+        shortLine = true;
+
+      entry.length += bases;
+      line = lineEnd == end ? end : newLine + 1;
+    }
+
+    add(entry);
+  }
+
+  return true;
+}
+
+bool FastaIndex::find(const std::string &text, Region &region) const
+{
+  // A name holding a ':' is taken as a whole record when it exists.
+  auto name = _names.find(text);
+  size_t begin = 1, end = static_cast<size_t>(-1);
+  if (name == _names.end()) {
+    const size_t colon = text.rfind(':');
+    if (colon == std::string::npos || (name = _names.find(text.substr(0, colon))) == _names.end())
+      return false;
+
+    if (!parseRange(text.substr(colon + 1), begin, end))
+      return false;
+  }
+
+  const Entry &entry = _entries.at(name->second);
+  region.name       = text;
+  region.recordName = name->first;
+  region.offset     = begin - 1;
+
+  // An empty record can only be read as a whole.
+  if (entry.length == 0 && begin == 1) {
+    region.length = 0;
+    region.first  = entry.offset;
+    region.last   = entry.offset;
+    return true;
+  }
+
+  if (begin > entry.length)
+    return false;
+
+  end = std::min(end, entry.length);
+
+  region.length = end - begin + 1;
+  region.first  = position(entry, begin - 1);
+  region.last   = position(entry, end - 1) + 1;
+
+  return true;
+}
+
+void FastaIndex::add(const Entry &entry)
+{
+  if (_names.insert(std::make_pair(entry.name, _entries.size())).second)
+    _entries.push_back(entry);
+}
+
+size_t FastaIndex::position(const Entry &entry, size_t nucleotide)
+{
+  return entry.offset + nucleotide / entry.lineBases * entry.lineWidth + nucleotide % entry.lineBases;
+}
+
+bool FastaIndex::parseRange(std::string range, size_t &begin, size_t &end)
+{
+  range.erase(std::remove(range.begin(), range.end(), ','), range.end());
+
+  char *next;
+  begin = strtoull(range.c_str(), &next, 10);
+  end   = static_cast<size_t>(-1);
+  if (next == range.c_str() || begin == 0)
+    return false;
+
+  if (*next == '-') {
+    const char *number = next + 1;
+    end = strtoull(number, &next, 10);
+    if (next == number || end < begin)
+      return false;
+  }
+
+  return *next == '\0';
+}
+
+std::string FastaIndex::sequenceId(const std::string &geneName)
+{
+  return geneName.substr(0, geneName.find_first_of(" \t\r"));
+}
@@ -0,0 +1,155 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef FASTAINDEX_H
+#define FASTAINDEX_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "fastareader.h"
+
+/**
+ * Index of the records of a FASTA file, in the samtools .fai format. It tells where the nucleotides of each record
+ * are in the file, so a record or a region of it can be read without parsing the records before it.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class FastaIndex final
+{
+  public:
+    /**
+     * A region of a record, with the file positions of its nucleotides, the name of its record and the position of
+     * its first nucleotide in the record.
+     *
+     */
+    struct Region
+    {
+      std::string name;
+      size_t      length;
+      size_t      first;
+      size_t      last;
+      std::string recordName;
+      size_t      offset;
+    };
+
+    /**
+     * Load a .fai file.
+     *
+     * @param indexFile The .fai file name.
+     *
+     * @return True if the file could be read, otherwise false.
+     *
+     */
+    bool load(const std::string &indexFile);
+
+    /**
+     * Store the index in a .fai file.
+     *
+     * @param indexFile The .fai file name.
+     *
+     * @return True if the file could be written, otherwise false.
+     *
+     */
+    bool save(const std::string &indexFile) const;
+
+    /**
+     * Build the index reading all the records of a FASTA file. The lines of each record must have the same length,
+     * except for the last one.
+     *
+     * @param reader Reader of the FASTA file. It must be just opened.
+     *
+     * @return True if the index could be built, false if the lines of a record have different lengths.
+     *
+     */
+    bool build(FastaReader &reader);
+
+    /**
+     * Load the .fai file of a FASTA file. When it does not exist, the index is built and stored in it.
+     *
+     * @param geneFile The FASTA file name. The index is stored in the same name with the .fai extension.
+     * @param reader Reader of the FASTA file. It must be just opened.
+     *
+     * @return True if the index could be loaded or built, false if the lines of a record have different lengths.
+     *
+     */
+    bool loadOrBuild(const std::string &geneFile, FastaReader &reader);
+
+    /**
+     * Find a region, given as "name", "name:begin" or "name:begin-end", with 1-based inclusive positions.
+     *
+     * @param text The region to be found.
+     * @param region Will receive the region. The end is limited to the record length.
+     *
+     * @return True if the record exists and the positions are valid, otherwise false.
+     *
+     */
+    bool find(const std::string &text, Region &region) const;
+
+    /**
+     * Parse the positions of a region, given as "begin" or "begin-end", with 1-based inclusive positions.
+     *
+     * @param range The positions to be parsed. Commas are ignored.
+     * @param begin Will receive the first position.
+     * @param end Will receive the last position, or the largest size_t when it is not given.
+     *
+     * @return True if the positions are valid, otherwise false.
+     *
+     */
+    static bool parseRange(std::string range, size_t &begin, size_t &end);
+
+    /**
+     * Returns the sequence id of a record, the name the index knows it by: its gene name up to the first blank.
+     *
+     * @param geneName The gene name, without the '>'.
+     *
+     * @return The sequence id.
+     *
+     */
+    static std::string sequenceId(const std::string &geneName);
+
+  private:
+    /**
+     * A line of the .fai file.
+     *
+     */
+    struct Entry
+    {
+      std::string name;
+      size_t      length;
+      size_t      offset;
+      size_t      lineBases;
+      size_t      lineWidth;
+    };
+
+    std::vector<Entry>                      _entries;
+    std::unordered_map<std::string, size_t> _names;
+
+    /**
+     * Helper to add an entry. When a name is repeated, the first record is kept.
+     *
+     */
+    void add(const Entry &entry);
+
+    /**
+     * Helper to find the file position of a nucleotide.
+     *
+     */
+    static size_t position(const Entry &entry, size_t nucleotide);
+};
+
+#endif
@@ -0,0 +1,210 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "fastareader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+FastaReader::FastaReader()
+{
+}
+
+FastaReader::~FastaReader()
+{
+  close();
+}
+
+bool FastaReader::open(const std::string &fileName)
+{
+  close();
+
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+    ::close(fd);
+    return false;
+  }
+
+  _size = st.st_size;
+  if (_size > 0) {
+    void *data = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      ::close(fd);
+      _size = 0;
+      return false;
+    }
+
+    _data = static_cast<char *>(data);
+    madvise(_data, _size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(_data, _size, MADV_HUGEPAGE);
+#endif
+  }
+
+  ::close(fd);
+  return true;
+}
+
+char *FastaReader::nextHeader(std::string &geneName)
+{
+  if (_position >= _size)
+    return nullptr;
+
+  char *const end = _data + _size;
+  char *line = _data + _position;
+
+  geneName.clear();
+  if (*line == '>') {
+    char *newLine = static_cast<char *>(memchr(line, '\n', end - line));
+    char *lineEnd = newLine ? newLine : end;
+
+    geneName.assign(line, lineEnd);
+    line = newLine ? newLine + 1 : end;
+  }
+
+  return line;
+}
+
+bool FastaReader::next(std::string &geneName, GeneSequence &geneSequence)
+{
+  char *line = nextHeader(geneName);
+  if (!line)
+    return false;
+
+  // Compact the lines in place until the next header, dropping the line breaks.
+  char *const end = _data + _size;
+  char *sequence  = line;
+  char *output    = line;
+  while (line < end && *line != '>') {
+    char *newLine = static_cast<char *>(memchr(line, '\n', end - line));
+    char *lineEnd = newLine ? newLine : end;
+
+    if (output != line)
+      memmove(output, line, lineEnd - line);
+
+    output += lineEnd - line;
+    line    = newLine ? newLine + 1 : end;
+  }
+
+  _position    = line - _data;
+  geneSequence = GeneSequence(sequence, output - sequence);
+
+  return true;
+}
+
+bool FastaReader::nextRaw(std::string &geneName, GeneSequence &rawSequence)
+{
+  char *line = nextHeader(geneName);
+  if (!line)
+    return false;
+
+  // The record ends at the first '>' that starts a line.
+  char *const end = _data + _size;
+  char *header    = line;
+  while (header < end && *header != '>') {
+    header = static_cast<char *>(memchr(header, '>', end - header));
+    if (!header)
+      header = end;
+    else if (header[-1] != '\n')
+      ++header;
+  }
+
+  _position   = header - _data;
+  rawSequence = GeneSequence(line, header - line);
+
+  return true;
+}
+
+bool FastaReader::slice(size_t first, size_t last, GeneSequence &rawSequence) const
+{
+  if (first > last || last > _size)
+    return false;
+
+  rawSequence = GeneSequence(_data + first, last - first);
+  return true;
+}
+
+size_t FastaReader::offset(const GeneSequence &geneSequence) const
+{
+  return geneSequence.data() - _data;
+}
+
+void FastaReader::release(const GeneSequence &geneSequence)
+{
+  const size_t pageSize = sysconf(_SC_PAGESIZE);
+  const size_t position = geneSequence.data() + geneSequence.size() - _data;
+  const size_t release  = position - position % pageSize;
+
+  if (release > _released) {
+    madvise(_data + _released, release - _released, MADV_DONTNEED);
+    _released = release;
+  }
+}
+
+size_t FastaReader::copyNucleotides(const GeneSequence &rawSequence, size_t &rawOffset, char *buffer, size_t capacity)
+{
+  const char *const end = rawSequence.data() + rawSequence.size();
+
+  size_t copied = 0;
+  while (copied < capacity && rawOffset < rawSequence.size()) {
+    const char *line    = rawSequence.data() + rawOffset;
+    const char *newLine = static_cast<const char *>(memchr(line, '\n', end - line));
+    const size_t length = std::min<size_t>((newLine ? newLine : end) - line, capacity - copied);
+
+    memcpy(buffer + copied, line, length);
+    copied    += length;
+    rawOffset += length;
+
+    if (rawOffset < rawSequence.size() && rawSequence[rawOffset] == '\n')
+      ++rawOffset;
+  }
+
+  return copied;
+}
+
+void FastaReader::close()
+{
+  if (_data)
+    munmap(_data, _size);
+
+  _data     = nullptr;
+  _size     = 0;
+  _position = 0;
+  _released = 0;
+}
+
+StreamedGeneSource::StreamedGeneSource(const GeneSequence &rawSequence, size_t chunkSize) : _rawSequence(rawSequence),
+  _chunkSize(chunkSize)
+{
+}
+
+void StreamedGeneSource::read(const std::function<void(const GeneSequence &)> &consumer) const
+{
+  std::string buffer(_chunkSize, '\0');
+
+  size_t rawOffset = 0, length;
+  while ((length = FastaReader::copyNucleotides(_rawSequence, rawOffset, &buffer[0], _chunkSize)) > 0)
+    consumer(GeneSequence(buffer.data(), length));
+}
@@ -0,0 +1,174 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef FASTAREADER_H
+#define FASTAREADER_H
+
+#include "genesource.h"
+
+/**
+ * Memory mapped FASTA file reader. The file is mapped as a private copy, so each record can be handed to the matcher
+ * without copying it: the line breaks are removed by compacting the record in place, inside the mapping.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class FastaReader final
+{
+  public:
+    /**
+     * Constructor.
+     *
+     */
+    FastaReader();
+
+    /**
+     * Destructor.
+     *
+     */
+    ~FastaReader();
+
+    FastaReader(const FastaReader &) = delete;
+    FastaReader &operator=(const FastaReader &) = delete;
+
+    /**
+     * Open and map a FASTA file.
+     *
+     * @param fileName FASTA file name.
+     *
+     * @return True if the file could be opened, otherwise false.
+     *
+     */
+    bool open(const std::string &fileName);
+
+    /**
+     * Read the next record of the file. The sequence is valid until it is released or the file is closed.
+     *
+     * @param geneName Will receive the record header line, including the '>'. Empty for lines before the first header.
+     * @param geneSequence Will receive the record nucleotides, without line breaks.
+     *
+     * @return True if a record was read, false if the end of the file was reached.
+     *
+     */
+    bool next(std::string &geneName, GeneSequence &geneSequence);
+
+    /**
+     * Read the next record of the file without touching it. The sequence still holds the line breaks, and can be
+     * consumed with copyNucleotides(). It is valid until it is released or the file is closed.
+     *
+     * @param geneName Will receive the record header line, including the '>'. Empty for lines before the first header.
+     * @param rawSequence Will receive the record lines, line breaks included.
+     *
+     * @return True if a record was read, false if the end of the file was reached.
+     *
+     */
+    bool nextRaw(std::string &geneName, GeneSequence &rawSequence);
+
+    /**
+     * Get a piece of the file without touching it, like the sequences returned by nextRaw(). It does not change the
+     * next record to be read.
+     *
+     * @param first File position of the first character.
+     * @param last File position after the last character.
+     * @param rawSequence Will receive the piece of the file.
+     *
+     * @return True if the piece is inside the file, otherwise false.
+     *
+     */
+    bool slice(size_t first, size_t last, GeneSequence &rawSequence) const;
+
+    /**
+     * Returns the file position of a sequence returned by next() or nextRaw().
+     *
+     */
+    size_t offset(const GeneSequence &geneSequence) const;
+
+    /**
+     * Give back the memory of the records already consumed, up to the end of a sequence. Records must be released in
+     * the order they were read, and it can be done from another thread than the one reading the records.
+     *
+     * @param geneSequence The last consumed sequence, as returned by next() or nextRaw().
+     *
+     */
+    void release(const GeneSequence &geneSequence);
+
+    /**
+     * Copy the nucleotides of a raw sequence to a buffer, skipping the line breaks.
+     *
+     * @param rawSequence The raw sequence, as returned by nextRaw().
+     * @param rawOffset Position in the raw sequence where the copy starts. It is moved to after the last copied byte.
+     * @param buffer Buffer that will receive the nucleotides.
+     * @param capacity Maximum number of nucleotides to be copied.
+     *
+     * @return The number of nucleotides copied, 0 when the raw sequence was fully consumed.
+     *
+     */
+    static size_t copyNucleotides(const GeneSequence &rawSequence, size_t &rawOffset, char *buffer, size_t capacity);
+
+    /**
+     * Unmap the file.
+     *
+     */
+    void close();
+
+  private:
+    char   *_data     = nullptr;
+    size_t  _size     = 0;
+    size_t  _position = 0;
+    size_t  _released = 0;
+
+    /**
+     * Helper to read the header line of the next record.
+     *
+     * @return Pointer to the first line after the header, or nullptr if the end of the file was reached.
+     *
+     */
+    char *nextHeader(std::string &geneName);
+};
+
+/**
+ * A gene source that streams a raw record straight from the mapped FASTA file, in chunks of a fixed size, so the
+ * memory used does not depend on the record size.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class StreamedGeneSource final : public GeneSource
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param rawSequence The raw sequence, as returned by FastaReader::nextRaw().
+     * @param chunkSize Number of nucleotides delivered per chunk.
+     *
+     */
+    StreamedGeneSource(const GeneSequence &rawSequence, size_t chunkSize);
+
+    /**
+     * Deliver the whole sequence in chunks of at most chunkSize nucleotides.
+     *
+     * @param consumer Function that will receive each chunk of the sequence.
+     *
+     */
+    void read(const std::function<void(const GeneSequence &)> &consumer) const;
+
+  private:
+    GeneSequence _rawSequence;
+    size_t       _chunkSize;
+};
+
+#endif
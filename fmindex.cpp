@@ -0,0 +1,434 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "fmindex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "fastareader.h"
+#include "binaryfile.h"
+
+static const char MAGIC[8] = { 'H', 'U', 'N', 'T', 'F', 'M', '0', '1' };
+
+template <typename T>
+static
+void buckets(const T *text, size_t length, size_t symbols, std::vector<size_t> &bucket, bool end)
+{
+  std::fill(bucket.begin(), bucket.end(), 0);
+  for (size_t i = 0; i < length; ++i)
+    ++bucket[text[i]];
+
+  size_t sum = 0;
+  for (size_t symbol = 0; symbol < symbols; ++symbol) {
+    sum += bucket[symbol];
+    bucket[symbol] = end ? sum : sum - bucket[symbol];
+  }
+}
+
+template <typename T, typename I>
+static
+void induce(const T *text, I *sa, size_t length, size_t symbols, const std::vector<bool> &stype,
+  std::vector<size_t> &bucket)
+{
+  const I EMPTY = static_cast<I>(-1);
+
+  buckets(text, length, symbols, bucket, false);
+  for (size_t i = 0; i < length; ++i) {
+    if (sa[i] != EMPTY && sa[i] > 0 && !stype[sa[i] - 1])
+      sa[bucket[text[sa[i] - 1]]++] = sa[i] - 1;
+  }
+
+  buckets(text, length, symbols, bucket, true);
+  for (size_t i = length; i > 0; --i) {
+    if (sa[i - 1] != EMPTY && sa[i - 1] > 0 && stype[sa[i - 1] - 1])
+      sa[--bucket[text[sa[i - 1] - 1]]] = sa[i - 1] - 1;
+  }
+}
+
+/**
+ * Suffix array construction by induced sorting (SA-IS). The last symbol of the text must be unique and the smallest,
+ * and the index type must hold the length, with the largest value left to mark the empty entries.
+ *
+ */
+template <typename T, typename I>
+static
+void suffixArray(const T *text, I *sa, size_t length, size_t symbols)
+{
+  const I EMPTY = static_cast<I>(-1);
+
+  if (length == 1) {
+    sa[0] = 0;
+    return;
+  }
+
+  std::vector<bool> stype(length, false);
+  stype[length - 1] = true;
+  for (size_t i = length - 1; i > 0; --i)
+    stype[i - 1] = text[i - 1] < text[i] || (text[i - 1] == text[i] && stype[i]);
+
+  auto isLMS = [&stype] (size_t i) -> bool {
+    return i > 0 && stype[i] && !stype[i - 1];
+  };
+
+  // Sort the LMS substrings.
+  std::vector<size_t> bucket(symbols);
+  buckets(text, length, symbols, bucket, true);
+  std::fill(sa, sa + length, EMPTY);
+  for (size_t i = 1; i < length; ++i) {
+    if (isLMS(i))
+      sa[--bucket[text[i]]] = i;
+  }
+  induce(text, sa, length, symbols, stype, bucket);
+
+  size_t lms = 0;
+  for (size_t i = 0; i < length; ++i) {
+    if (isLMS(sa[i]))
+      sa[lms++] = sa[i];
+  }
+
+  // Name the LMS substrings, equal substrings receive the same name.
+  std::fill(sa + lms, sa + length, EMPTY);
+  size_t names    = 0;
+  I      previous = EMPTY;
+  for (size_t i = 0; i < lms; ++i) {
+    const I position = sa[i];
+    bool diff = false;
+    for (size_t d = 0; d < length; ++d) {
+      if (previous == EMPTY || text[position + d] != text[previous + d] ||
+        stype[position + d] != stype[previous + d]) {
+        diff = true;
+        break;
+      }
+
+      if (d > 0 && (isLMS(position + d) || isLMS(previous + d)))
+        break;
+    }
+
+    if (diff) {
+      ++names;
+      previous = position;
+    }
+    sa[lms + position / 2] = names - 1;
+  }
+
+  for (size_t i = length, j = length; i > lms; --i) {
+    if (sa[i - 1] != EMPTY)
+      sa[--j] = sa[i - 1];
+  }
+
+  // Sort the LMS suffixes, recursing when the names are not unique.
+  I *reduced = sa + length - lms;
+  if (names < lms)
+    suffixArray(reduced, sa, lms, names);
+  else {
+    for (size_t i = 0; i < lms; ++i)
+      sa[reduced[i]] = i;
+  }
+
+  // Induce the order of all suffixes from the sorted LMS suffixes.
+  for (size_t i = 1, j = 0; i < length; ++i) {
+    if (isLMS(i))
+      reduced[j++] = i;
+  }
+
+  for (size_t i = 0; i < lms; ++i)
+    sa[i] = reduced[sa[i]];
+
+  std::fill(sa + lms, sa + length, EMPTY);
+  buckets(text, length, symbols, bucket, true);
+  for (size_t i = lms; i > 0; --i) {
+    const I position = sa[i - 1];
+    sa[i - 1] = EMPTY;
+    sa[--bucket[text[position]]] = position;
+  }
+  induce(text, sa, length, symbols, stype, bucket);
+}
+
+FmIndex::FmIndex()
+{
+}
+
+FmIndex::~FmIndex()
+{
+  close();
+}
+
+void FmIndex::build(const std::string &geneFile, const std::string &indexFile)
+{
+  FastaReader reader;
+
+  if (!reader.open(geneFile))
+    throw FmIndexException("Problems to open the input file: " + geneFile);
+
+  // Every record is followed by a separator, and the last one by the terminator.
+  std::string           text, names;
+  std::vector<uint64_t> begins, offsets;
+  std::string           geneName;
+  GeneSequence          geneSequence;
+  while (reader.next(geneName, geneSequence)) {
+    begins.push_back(text.size());
+    offsets.push_back(names.size());
+    text.append(geneSequence.data(), geneSequence.size());
+    text += '#';
+    names += geneName;
+    reader.release(geneSequence);
+  }
+
+  if (text.empty())
+    text += '#';
+  text.back() = '$';
+  begins.push_back(text.size());
+  offsets.push_back(names.size());
+
+  const size_t length = text.size();
+  std::vector<uint8_t> symbols(length);
+  for (size_t i = 0; i < length; ++i) {
+    switch (text[i]) {
+      case 'A':
+        symbols[i] = A;
+      break;
+      case 'C':
+        symbols[i] = C;
+      break;
+      case 'G':
+        symbols[i] = G;
+      break;
+      case 'T':
+        symbols[i] = T;
+      break;
+      default:
+        symbols[i] = OTHER;
+    }
+  }
+
+  for (size_t i = 1; i < begins.size(); ++i)
+    symbols[begins[i] - 1] = SEPARATOR;
+  symbols[length - 1] = TERMINATOR;
+
+  // The suffix array is the largest buffer of the build, so it takes 32 bits indices whenever they are enough.
+  std::vector<uint32_t> sa32;
+  std::vector<size_t>   sa64;
+  if (length < static_cast<uint64_t>(1) << 32) {
+    sa32.resize(length);
+    suffixArray(symbols.data(), sa32.data(), length, SYMBOLS);
+  }
+  else {
+    sa64.resize(length);
+    suffixArray(symbols.data(), sa64.data(), length, SYMBOLS);
+  }
+
+  auto sa = [&sa32, &sa64] (size_t row) -> size_t { return sa32.empty() ? sa64[row] : sa32[row]; };
+
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.length    = length;
+  header.records   = begins.size() - 1;
+  header.namesSize = names.size();
+
+  std::vector<Block>    blocks(length / BLOCK_SIZE + 1);
+  std::vector<uint64_t> samples;
+  uint64_t              counts[SYMBOLS] = {};
+  for (size_t row = 0; row <= length; ++row) {
+    Block &block = blocks[row / BLOCK_SIZE];
+    const size_t bit = row % BLOCK_SIZE;
+
+    if (bit == 0) {
+      std::memset(&block, 0, sizeof(Block));
+      std::copy(counts, counts + SYMBOLS, block.counts);
+      block.samples = samples.size();
+    }
+
+    if (row == length)
+      break;
+
+    const size_t  position = sa(row);
+    const uint8_t symbol   = symbols[position > 0 ? position - 1 : length - 1];
+    for (size_t plane = 0; plane < 3; ++plane)
+      block.planes[plane] |= static_cast<uint64_t>((symbol >> plane) & 1) << bit;
+    ++counts[symbol];
+
+    if (position % SAMPLE_RATE == 0) {
+      block.sampled |= static_cast<uint64_t>(1) << bit;
+      samples.push_back(position);
+    }
+  }
+
+  header.counts[0] = 0;
+  for (size_t symbol = 0; symbol < SYMBOLS; ++symbol)
+    header.counts[symbol + 1] = header.counts[symbol] + counts[symbol];
+
+  std::ofstream os(indexFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!os)
+    throw FmIndexException("Problems to create the index file: " + indexFile);
+
+  BinaryFile::write(os, &header, sizeof(Header));
+  BinaryFile::write(os, begins.data(), begins.size() * sizeof(uint64_t));
+  BinaryFile::write(os, offsets.data(), offsets.size() * sizeof(uint64_t));
+  BinaryFile::write(os, names.data(), names.size());
+  BinaryFile::write(os, text.data(), text.size());
+  BinaryFile::write(os, blocks.data(), blocks.size() * sizeof(Block));
+  BinaryFile::write(os, samples.data(), samples.size() * sizeof(uint64_t));
+
+  if (!os.flush())
+    throw FmIndexException("Problems to write the index file: " + indexFile);
+}
+
+bool FmIndex::open(const std::string &indexFile)
+{
+  close();
+
+  if (!BinaryFile::map(indexFile, sizeof(Header), _data, _size))
+    return false;
+
+  _header = reinterpret_cast<const Header *>(_data);
+
+  const size_t length  = _header->length;
+  const size_t records = _header->records;
+  if (std::memcmp(_header->magic, MAGIC, sizeof(MAGIC)) != 0 || length == 0 || records > length) {
+    close();
+    return false;
+  }
+
+  size_t offset = BinaryFile::align(sizeof(Header));
+  _begins  = reinterpret_cast<const uint64_t *>(_data + offset);
+  offset  += BinaryFile::align((records + 1) * sizeof(uint64_t));
+  _offsets = reinterpret_cast<const uint64_t *>(_data + offset);
+  offset  += BinaryFile::align((records + 1) * sizeof(uint64_t));
+  _names   = _data + offset;
+  offset  += BinaryFile::align(_header->namesSize);
+  _text    = _data + offset;
+  offset  += BinaryFile::align(length);
+  _blocks  = reinterpret_cast<const Block *>(_data + offset);
+  offset  += (length / BLOCK_SIZE + 1) * sizeof(Block);
+  _samples = reinterpret_cast<const uint64_t *>(_data + offset);
+  offset  += ((length + SAMPLE_RATE - 1) / SAMPLE_RATE) * sizeof(uint64_t);
+
+  if (offset != _size) {
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+void FmIndex::search(const StateMachine &stateMachine, size_t maxMismatch, std::vector<size_t> &positions) const
+{
+  if (_header && stateMachine.size() > 0)
+    backtrack(stateMachine, stateMachine.size(), 0, _header->length, 0, maxMismatch, positions);
+}
+
+void FmIndex::backtrack(const StateMachine &stateMachine, size_t last, size_t low, size_t high, size_t mismatches,
+  size_t maxMismatch, std::vector<size_t> &positions) const
+{
+  if (last == 0) {
+    for (size_t row = low; row < high; ++row)
+      positions.push_back(locate(row));
+    return;
+  }
+
+  static const char nucleotides[] = "ACGT";
+
+  // The separators and the terminator are never extended, so the matches never cross the records.
+  const State &state = stateMachine.state(last - 1);
+  for (size_t symbol = A; symbol <= OTHER; ++symbol) {
+    const bool match = symbol != OTHER && state.contains(nucleotides[symbol - A]);
+    if (!match && (!state.acceptMismatch() || mismatches == maxMismatch))
+      continue;
+
+    const size_t newLow  = _header->counts[symbol] + rank(symbol, low);
+    const size_t newHigh = _header->counts[symbol] + rank(symbol, high);
+    if (newLow < newHigh)
+      backtrack(stateMachine, last - 1, newLow, newHigh, mismatches + (match ? 0 : 1), maxMismatch, positions);
+  }
+}
+
+size_t FmIndex::rank(size_t symbol, size_t row) const
+{
+  const Block &block = _blocks[row / BLOCK_SIZE];
+  const size_t bit   = row % BLOCK_SIZE;
+
+  size_t count = block.counts[symbol];
+  if (bit > 0) {
+    uint64_t mask = (static_cast<uint64_t>(1) << bit) - 1;
+    for (size_t plane = 0; plane < 3; ++plane)
+      mask &= ((symbol >> plane) & 1) ? block.planes[plane] : ~block.planes[plane];
+    count += __builtin_popcountll(mask);
+  }
+
+  return count;
+}
+
+size_t FmIndex::locate(size_t row) const
+{
+  // Walk the text backwards until a sampled position is found.
+  for (size_t steps = 0;; ++steps) {
+    const Block &block = _blocks[row / BLOCK_SIZE];
+    const size_t bit   = row % BLOCK_SIZE;
+    const uint64_t below = (static_cast<uint64_t>(1) << bit) - 1;
+
+    if ((block.sampled >> bit) & 1)
+      return _samples[block.samples + __builtin_popcountll(block.sampled & below)] + steps;
+
+    size_t symbol = 0;
+    for (size_t plane = 0; plane < 3; ++plane)
+      symbol |= ((block.planes[plane] >> bit) & 1) << plane;
+
+    row = _header->counts[symbol] + rank(symbol, row);
+  }
+}
+
+size_t FmIndex::records() const
+{
+  return _header ? _header->records : 0;
+}
+
+size_t FmIndex::record(size_t position) const
+{
+  return std::upper_bound(_begins, _begins + _header->records + 1, position) - _begins - 1;
+}
+
+size_t FmIndex::begin(size_t record) const
+{
+  return _begins[record];
+}
+
+std::string FmIndex::name(size_t record) const
+{
+  return std::string(_names + _offsets[record], _offsets[record + 1] - _offsets[record]);
+}
+
+GeneSequence FmIndex::sequence(size_t record) const
+{
+  return GeneSequence(_text + _begins[record], _begins[record + 1] - _begins[record] - 1);
+}
+
+void FmIndex::close()
+{
+  if (_data)
+    BinaryFile::unmap(_data, _size);
+
+  _data    = nullptr;
+  _size    = 0;
+  _header  = nullptr;
+  _begins  = nullptr;
+  _offsets = nullptr;
+  _names   = nullptr;
+  _text    = nullptr;
+  _blocks  = nullptr;
+  _samples = nullptr;
+}
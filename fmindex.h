@@ -0,0 +1,224 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef FMINDEX_H
+#define FMINDEX_H
+
+#include <vector>
+
+#include "statemachine.h"
+#include "genesequence.h"
+
+/**
+ * Exception fired when an index cannot be built.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class FmIndexException final : public std::exception
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param reason The exception reason.
+     *
+     */
+    FmIndexException(const std::string &reason) : _reason(reason)
+    {
+    }
+
+    /**
+     * Returns the exception reason.
+     *
+     * @return The exception reason.
+     *
+     */
+    const char *what() const _NOEXCEPT
+    {
+      return _reason.c_str();
+    }
+
+  private:
+    std::string _reason;
+};
+
+/**
+ * FM-index of all the records of a FASTA file, stored in a file that is memory mapped when opened. The index holds
+ * the records too, so the matches can be verified and written without the FASTA file.
+ *
+ * The records are concatenated with a separator between them, the Burrows-Wheeler transform is stored as 3 bit planes
+ * with the symbol counts at every 64 rows, and the suffix array is sampled at every 32 text positions. A search
+ * walks the state machine backwards, so its cost depends on the pattern and on the number of hits, not on the size of
+ * the records.
+ *
+ * The index takes about 2.75 bytes per nucleotide, plus the record names: 1 byte for the text, 1.5 bytes for the
+ * transform blocks and 0.25 bytes for the suffix array samples.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class FmIndex final
+{
+  public:
+    /**
+     * Constructor.
+     *
+     */
+    FmIndex();
+
+    /**
+     * Destructor.
+     *
+     */
+    ~FmIndex();
+
+    FmIndex(const FmIndex &) = delete;
+    FmIndex &operator=(const FmIndex &) = delete;
+
+    /**
+     * Build the index of a FASTA file and store it in a file. The build holds the text, the suffix array and the
+     * index in memory, about 8 bytes per nucleotide, or 12 bytes when the text has 2^32 symbols or more.
+     *
+     * @param geneFile Gene Fasta file.
+     * @param indexFile File that will receive the index.
+     *
+     */
+    static void build(const std::string &geneFile, const std::string &indexFile);
+
+    /**
+     * Open and map an index file.
+     *
+     * @param indexFile Index file name.
+     *
+     * @return True if the file could be opened and is a valid index, otherwise false.
+     *
+     */
+    bool open(const std::string &indexFile);
+
+    /**
+     * Find all the positions where a state machine matches with up to maxMismatch mismatches.
+     *
+     * @param stateMachine The state machine to be searched. It must have at least one state.
+     * @param maxMismatch Maximum number of mismatches.
+     * @param positions Vector that will receive the text positions where the matches begin, in no particular order.
+     *
+     */
+    void search(const StateMachine &stateMachine, size_t maxMismatch, std::vector<size_t> &positions) const;
+
+    /**
+     * Returns the number of records.
+     *
+     */
+    size_t records() const;
+
+    /**
+     * Returns the record holding a text position.
+     *
+     */
+    size_t record(size_t position) const;
+
+    /**
+     * Returns the text position of the first nucleotide of a record.
+     *
+     */
+    size_t begin(size_t record) const;
+
+    /**
+     * Returns the header line of a record, including the '>'.
+     *
+     */
+    std::string name(size_t record) const;
+
+    /**
+     * Returns the nucleotides of a record. They are valid until the index is closed.
+     *
+     */
+    GeneSequence sequence(size_t record) const;
+
+    /**
+     * Unmap the index file.
+     *
+     */
+    void close();
+
+  private:
+    /**
+     * Symbols of the text: the terminator, the record separator, the four nucleotides and any other character.
+     *
+     */
+    enum Symbol { TERMINATOR, SEPARATOR, A, C, G, T, OTHER, SYMBOLS };
+
+    static const size_t BLOCK_SIZE  = 64;
+    static const size_t SAMPLE_RATE = 32;
+
+    /**
+     * Beginning of the index file.
+     *
+     */
+    struct Header
+    {
+      char     magic[8];
+      uint64_t length;
+      uint64_t records;
+      uint64_t namesSize;
+      uint64_t counts[SYMBOLS + 1];
+    };
+
+    /**
+     * The transform of BLOCK_SIZE rows: the symbol counts and the sampled rows before them, and the bit planes and
+     * the sampled rows of the block.
+     *
+     */
+    struct Block
+    {
+      uint64_t counts[SYMBOLS];
+      uint64_t samples;
+      uint64_t planes[3];
+      uint64_t sampled;
+    };
+
+    char           *_data    = nullptr;
+    size_t          _size    = 0;
+    const Header   *_header  = nullptr;
+    const uint64_t *_begins  = nullptr;
+    const uint64_t *_offsets = nullptr;
+    const char     *_names   = nullptr;
+    const char     *_text    = nullptr;
+    const Block    *_blocks  = nullptr;
+    const uint64_t *_samples = nullptr;
+
+    /**
+     * Helper to walk the states backwards, from the state before last, extending the range of rows [low, high).
+     *
+     */
+    void backtrack(const StateMachine &stateMachine, size_t last, size_t low, size_t high, size_t mismatches,
+      size_t maxMismatch, std::vector<size_t> &positions) const;
+
+    /**
+     * Helper to count the occurrences of a symbol in the rows before a row.
+     *
+     */
+    size_t rank(size_t symbol, size_t row) const;
+
+    /**
+     * Helper to find the text position of a row.
+     *
+     */
+    size_t locate(size_t row) const;
+};
+
+#endif
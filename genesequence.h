@@ -0,0 +1,104 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef GENESEQUENCE_H
+#define GENESEQUENCE_H
+
+#include <string>
+
+/**
+ * A read only view of a sequence of nucleotides. It does not own the memory, that must be kept alive by whoever
+ * created the view (usually the FASTA reader).
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class GeneSequence final
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param data First nucleotide of the sequence.
+     * @param size Number of nucleotides in the sequence.
+     *
+     */
+    GeneSequence(const char *data = nullptr, size_t size = 0) : _data(data), _size(size)
+    {
+    }
+
+    /**
+     * Constructor.
+     *
+     * @param sequence String holding the nucleotides. It must outlive the view.
+     *
+     */
+    GeneSequence(const std::string &sequence) : _data(sequence.data()), _size(sequence.size())
+    {
+    }
+
+    /**
+     * Returns the first nucleotide of the sequence.
+     *
+     * @return Pointer to the first nucleotide of the sequence.
+     *
+     */
+    const char *data() const
+    {
+      return _data;
+    }
+
+    /**
+     * Returns the number of nucleotides in the sequence.
+     *
+     * @return Number of nucleotides in the sequence.
+     *
+     */
+    size_t size() const
+    {
+      return _size;
+    }
+
+    /**
+     * Returns if the sequence has no nucleotides.
+     *
+     * @return True if the sequence is empty, otherwise false.
+     *
+     */
+    bool empty() const
+    {
+      return _size == 0;
+    }
+
+    /**
+     * Returns a nucleotide of the sequence.
+     *
+     * @param idx Position of the nucleotide.
+     *
+     * @return The nucleotide at the requested position.
+     *
+     */
+    char operator[](size_t idx) const
+    {
+      return _data[idx];
+    }
+
+  private:
+    const char *_data;
+    size_t      _size;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef GENESOURCE_H
+#define GENESOURCE_H
+
+#include <functional>
+
+#include "genesequence.h"
+
+/**
+ * Something that can deliver a gene sequence, in one or more consecutive chunks. It is used by the writers, so a
+ * record does not need to be fully held in memory to be written.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class GeneSource
+{
+  public:
+    /**
+     * Destructor.
+     *
+     */
+    virtual ~GeneSource()
+    {
+    }
+
+    /**
+     * Deliver the whole sequence, from the first nucleotide to the last one, in consecutive chunks.
+     *
+     * @param consumer Function that will receive each chunk of the sequence.
+     *
+     */
+    virtual void read(const std::function<void(const GeneSequence &)> &consumer) const = 0;
+};
+
+/**
+ * A gene source for a sequence that is already fully held in memory.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class BufferedGeneSource final : public GeneSource
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param geneSequence The sequence to be delivered. It must outlive this object.
+     *
+     */
+    BufferedGeneSource(const GeneSequence &geneSequence) : _geneSequence(geneSequence)
+    {
+    }
+
+    /**
+     * Deliver the whole sequence as a single chunk.
+     *
+     * @param consumer Function that will receive the sequence.
+     *
+     */
+    void read(const std::function<void(const GeneSequence &)> &consumer) const
+    {
+      consumer(_geneSequence);
+    }
+
+  private:
+    GeneSequence _geneSequence;
+};
+
+#endif
@@ -35,12 +35,16 @@ size_t PositionToMark::patternUsed() const
   return _patternUsed;
 }
 
-HIT::HIT(size_t begin, size_t end, size_t numberMismatches, const StateMachine &stateMachine) : _begin(begin),
-  _end(end), _numberMismatches(numberMismatches), _stateMachine(stateMachine)
+bool PositionToMark::before(const PositionToMark &p1, const PositionToMark &p2)
 {
+  if (p1.position() == p2.position())
+    return p1.type() < p2.type();
+
+  return p1.position() < p2.position();
 }
 
-HIT::HIT(const HIT &obj) : _begin(obj._begin), _end(obj._end), _numberMismatches(obj._numberMismatches), _stateMachine(obj._stateMachine)
+HIT::HIT(size_t begin, size_t end, size_t numberMismatches, size_t patternId) : _begin(begin), _end(end),
+  _numberMismatches(numberMismatches), _patternId(patternId)
 {
 }
 
@@ -54,21 +58,12 @@ size_t HIT::end() const
   return _end;
 }
 
-const StateMachine &HIT::stateMachine() const
-{
-  return _stateMachine;
-}
-
-HIT &HIT::operator=(const HIT &obj)
+size_t HIT::numberMismatches() const
 {
-  _begin            = obj._begin;
-  _end              = obj._end;
-  _stateMachine     = obj._stateMachine;
-  _numberMismatches = obj._numberMismatches;
-  return *this;
+  return _numberMismatches;
 }
 
-size_t HIT::numberMismatches() const
+size_t HIT::patternId() const
 {
-  return _numberMismatches;
+  return _patternId;
 }
@@ -65,6 +65,17 @@ class PositionToMark final
      */
     size_t patternUsed() const;
 
+    /**
+     * Order of the marks given to the sinks: by position, and by type at the same position.
+     *
+     * @param p1 First mark.
+     * @param p2 Second mark.
+     *
+     * @return True if the first mark comes before the second one.
+     *
+     */
+    static bool before(const PositionToMark &p1, const PositionToMark &p2);
+
   private:
     Type   _type;
     size_t _position;
@@ -72,7 +83,8 @@ class PositionToMark final
 };
 
 /**
- * This class will store information about the sequence gene match.
+ * This class will store information about the sequence gene match. It is a plain record, the state machine used on
+ * the match is identified by its position in the pattern table of HunT.
  *
  * @author Leonardo Bispo de Oliveira.
  *
@@ -86,18 +98,10 @@ class HIT final
      * @param begin Position where the match is beginning.
      * @param end Position where the match is ending.
      * @param numberMismatches Number of mismatches happened on this match.
-     * @param stateMachine The state machine used on this matching.
-     *
-     */
-    HIT(size_t begin, size_t end, size_t numberMismatches, const StateMachine &stateMachine);
-
-    /**
-     * Copy constructor.
-     *
-     * @param obj Object to be copied.
+     * @param patternId Position of the state machine used on this matching in the pattern table.
      *
      */
-    HIT(const HIT &obj);
+    HIT(size_t begin, size_t end, size_t numberMismatches, size_t patternId);
 
     /**
      * Returns the position where the match is beginning.
@@ -114,6 +118,7 @@ class HIT final
      *
      */
     size_t end() const;
+
     /**
      * Returns the number of mismatches happened on this match.
      *
@@ -123,28 +128,18 @@ class HIT final
     size_t numberMismatches() const;
 
     /**
-     * Returns the state machine used on this matching. 
-     *
-     * @return State machine used on this matching.
-     *
-     */
-    const StateMachine &stateMachine() const;
-
-    /**
-     * Attribute operator.
-     *
-     * @param obje Object to be copied.
+     * Returns the position of the state machine used on this matching in the pattern table.
      *
-     * @return Reference to this object.
+     * @return Position of the state machine used on this matching.
      *
      */
-    HIT &operator=(const HIT &obj);
+    size_t patternId() const;
 
   private:
-    size_t       _begin;
-    size_t       _end;
-    size_t       _numberMismatches;
-    StateMachine _stateMachine; 
+    size_t   _begin;
+    size_t   _end;
+    uint32_t _numberMismatches;
+    uint32_t _patternId;
 };
 
 #endif
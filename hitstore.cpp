@@ -0,0 +1,250 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "hitstore.h"
+
+#include <cstring>
+
+#include "binaryfile.h"
+
+static const char MAGIC[8] = { 'H', 'U', 'N', 'T', 'H', 'S', '0', '1' };
+
+HitStore::HitStore()
+{
+}
+
+HitStore::~HitStore()
+{
+  close();
+}
+
+bool HitStore::open(const std::string &storeFile)
+{
+  close();
+
+  if (!BinaryFile::map(storeFile, sizeof(Header), _data, _size))
+    return false;
+
+  _header = reinterpret_cast<const Header *>(_data);
+
+  if (std::memcmp(_header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+    close();
+    return false;
+  }
+
+  const size_t hits     = _header->hits;
+  const size_t records  = _header->records;
+  const size_t patterns = _header->patterns;
+
+  size_t offset = BinaryFile::align(sizeof(Header));
+  _recordIds      = reinterpret_cast<const uint32_t *>(_data + offset);
+  offset         += BinaryFile::align(hits * sizeof(uint32_t));
+  _patternIds     = reinterpret_cast<const uint32_t *>(_data + offset);
+  offset         += BinaryFile::align(hits * sizeof(uint32_t));
+  _begins         = reinterpret_cast<const uint64_t *>(_data + offset);
+  offset         += BinaryFile::align(hits * sizeof(uint64_t));
+  _ends           = reinterpret_cast<const uint64_t *>(_data + offset);
+  offset         += BinaryFile::align(hits * sizeof(uint64_t));
+  _mismatches     = reinterpret_cast<const uint32_t *>(_data + offset);
+  offset         += BinaryFile::align(hits * sizeof(uint32_t));
+  _nameOffsets    = reinterpret_cast<const uint64_t *>(_data + offset);
+  offset         += BinaryFile::align((records + 1) * sizeof(uint64_t));
+  _names          = _data + offset;
+  offset         += BinaryFile::align(_header->namesSize);
+  _patternOffsets = reinterpret_cast<const uint64_t *>(_data + offset);
+  offset         += BinaryFile::align((2 * patterns + 1) * sizeof(uint64_t));
+  _dictionary     = _data + offset;
+  offset         += BinaryFile::align(_header->dictionarySize);
+  _strands        = _data + offset;
+  offset         += BinaryFile::align(patterns);
+  _minimums       = reinterpret_cast<const uint16_t *>(_data + offset);
+  offset         += BinaryFile::align(patterns * sizeof(uint16_t));
+  _commandLine    = _data + offset;
+  offset         += BinaryFile::align(_header->commandLineSize);
+
+  if (offset != _size) {
+    close();
+    return false;
+  }
+
+  if (_nameOffsets[records] != _header->namesSize || _patternOffsets[2 * patterns] != _header->dictionarySize) {
+    close();
+    return false;
+  }
+
+  // The ids are checked once, so the accessors can trust them.
+  for (size_t hit = 0; hit < hits; ++hit) {
+    if (_recordIds[hit] >= records || _patternIds[hit] >= patterns) {
+      close();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+size_t HitStore::hits() const
+{
+  return _header ? _header->hits : 0;
+}
+
+size_t HitStore::records() const
+{
+  return _header ? _header->records : 0;
+}
+
+size_t HitStore::recordId(size_t hit) const
+{
+  return _recordIds[hit];
+}
+
+size_t HitStore::patternId(size_t hit) const
+{
+  return _patternIds[hit];
+}
+
+size_t HitStore::begin(size_t hit) const
+{
+  return _begins[hit];
+}
+
+size_t HitStore::end(size_t hit) const
+{
+  return _ends[hit];
+}
+
+size_t HitStore::numberMismatches(size_t hit) const
+{
+  return _mismatches[hit];
+}
+
+std::string HitStore::name(size_t record) const
+{
+  return std::string(_names + _nameOffsets[record], _nameOffsets[record + 1] - _nameOffsets[record]);
+}
+
+std::vector<StateMachine> HitStore::stateMachines() const
+{
+  std::vector<StateMachine> ret;
+
+  for (size_t i = 0; _header && i < _header->patterns; ++i) {
+    const uint64_t *offsets = _patternOffsets + 2 * i;
+    ret.push_back(StateMachine(std::string(_dictionary + offsets[0], offsets[1] - offsets[0]),
+      std::string(_dictionary + offsets[1], offsets[2] - offsets[1]), _minimums[i], _strands[i]));
+  }
+
+  return ret;
+}
+
+std::string HitStore::commandLine() const
+{
+  return _header ? std::string(_commandLine, _header->commandLineSize) : std::string();
+}
+
+void HitStore::close()
+{
+  if (_data)
+    BinaryFile::unmap(_data, _size);
+
+  _data           = nullptr;
+  _size           = 0;
+  _header         = nullptr;
+  _recordIds      = nullptr;
+  _patternIds     = nullptr;
+  _begins         = nullptr;
+  _ends           = nullptr;
+  _mismatches     = nullptr;
+  _nameOffsets    = nullptr;
+  _names          = nullptr;
+  _patternOffsets = nullptr;
+  _dictionary     = nullptr;
+  _strands        = nullptr;
+  _minimums       = nullptr;
+  _commandLine    = nullptr;
+}
+
+HitStoreSink::HitStoreSink(const std::string &fileName, const std::vector<StateMachine> &patterns) :
+  _fileName(fileName + ".hits"), _patterns(patterns), _nameOffsets(1, 0)
+{
+}
+
+void HitStoreSink::createHeader(const std::string &commandLine)
+{
+  _commandLine = commandLine;
+}
+
+void HitStoreSink::appendGene(const std::string &, const std::string &recordName, size_t offset, const GeneSource &,
+  const std::vector<PositionToMark> &, const std::vector<HIT> &hit)
+{
+  const uint32_t record = _nameOffsets.size() - 1;
+
+  _names += recordName;
+  _nameOffsets.push_back(_names.size());
+
+  for (auto &h : hit) {
+    _recordIds.push_back(record);
+    _patternIds.push_back(h.patternId());
+    _begins.push_back(offset + h.begin());
+    _ends.push_back(offset + h.end());
+    _mismatches.push_back(h.numberMismatches());
+  }
+}
+
+void HitStoreSink::createFooter(size_t)
+{
+  std::string           dictionary;
+  std::vector<uint64_t> patternOffsets(1, 0);
+  std::vector<char>     strands;
+  std::vector<uint16_t> minimums;
+  for (auto &stateMachine : _patterns) {
+    dictionary += stateMachine.label();
+    patternOffsets.push_back(dictionary.size());
+    dictionary += stateMachine.pattern();
+    patternOffsets.push_back(dictionary.size());
+    strands.push_back(stateMachine.strand());
+    minimums.push_back(stateMachine.minNumberOfPatterns());
+  }
+
+  HitStore::Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.hits            = _recordIds.size();
+  header.records         = _nameOffsets.size() - 1;
+  header.patterns        = _patterns.size();
+  header.namesSize       = _names.size();
+  header.dictionarySize  = dictionary.size();
+  header.commandLineSize = _commandLine.size();
+
+  std::ofstream os(_fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!os)
+    throw HitStoreException("Problems to create the hit store file: " + _fileName);
+
+  BinaryFile::write(os, &header, sizeof(HitStore::Header));
+  BinaryFile::write(os, _recordIds.data(), _recordIds.size() * sizeof(uint32_t));
+  BinaryFile::write(os, _patternIds.data(), _patternIds.size() * sizeof(uint32_t));
+  BinaryFile::write(os, _begins.data(), _begins.size() * sizeof(uint64_t));
+  BinaryFile::write(os, _ends.data(), _ends.size() * sizeof(uint64_t));
+  BinaryFile::write(os, _mismatches.data(), _mismatches.size() * sizeof(uint32_t));
+  BinaryFile::write(os, _nameOffsets.data(), _nameOffsets.size() * sizeof(uint64_t));
+  BinaryFile::write(os, _names.data(), _names.size());
+  BinaryFile::write(os, patternOffsets.data(), patternOffsets.size() * sizeof(uint64_t));
+  BinaryFile::write(os, dictionary.data(), dictionary.size());
+  BinaryFile::write(os, strands.data(), strands.size());
+  BinaryFile::write(os, minimums.data(), minimums.size() * sizeof(uint16_t));
+  BinaryFile::write(os, _commandLine.data(), _commandLine.size());
+
+  if (!os.flush())
+    throw HitStoreException("Problems to write the hit store file: " + _fileName);
+}
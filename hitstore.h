@@ -0,0 +1,249 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef HITSTORE_H
+#define HITSTORE_H
+
+#include <fstream>
+
+#include "sink.h"
+
+/**
+ * Exception fired when a hit store cannot be written or rendered.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class HitStoreException final : public std::exception
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param reason The exception reason.
+     *
+     */
+    HitStoreException(const std::string &reason) : _reason(reason)
+    {
+    }
+
+    /**
+     * Returns the exception reason.
+     *
+     * @return The exception reason.
+     *
+     */
+    const char *what() const _NOEXCEPT
+    {
+      return _reason.c_str();
+    }
+
+  private:
+    std::string _reason;
+};
+
+/**
+ * The hits of a search, stored in a file that is memory mapped when opened, so they can be filtered and written in
+ * any format without searching the gene sequences again.
+ *
+ * The hits are stored by column: record id, pattern id, begin, end and number of mismatches, each column an array
+ * with one entry per hit, in the order they were found. The names of the records with hits, the pattern table and
+ * the command line of the search are stored after the columns.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class HitStore final
+{
+  public:
+    /**
+     * Constructor.
+     *
+     */
+    HitStore();
+
+    /**
+     * Destructor.
+     *
+     */
+    ~HitStore();
+
+    HitStore(const HitStore &) = delete;
+    HitStore &operator=(const HitStore &) = delete;
+
+    /**
+     * Open and map a hit store file.
+     *
+     * @param storeFile Hit store file name.
+     *
+     * @return True if the file could be opened and is a valid hit store, otherwise false.
+     *
+     */
+    bool open(const std::string &storeFile);
+
+    /**
+     * Returns the number of hits.
+     *
+     */
+    size_t hits() const;
+
+    /**
+     * Returns the number of records with hits.
+     *
+     */
+    size_t records() const;
+
+    /**
+     * Returns the record of a hit.
+     *
+     */
+    size_t recordId(size_t hit) const;
+
+    /**
+     * Returns the position of the state machine of a hit in the pattern table.
+     *
+     */
+    size_t patternId(size_t hit) const;
+
+    /**
+     * Returns the position where a hit is beginning.
+     *
+     */
+    size_t begin(size_t hit) const;
+
+    /**
+     * Returns the position where a hit is ending.
+     *
+     */
+    size_t end(size_t hit) const;
+
+    /**
+     * Returns the number of mismatches of a hit.
+     *
+     */
+    size_t numberMismatches(size_t hit) const;
+
+    /**
+     * Returns the gene name of a record, without the '>'.
+     *
+     */
+    std::string name(size_t record) const;
+
+    /**
+     * Returns the pattern table used in the search, with the state machines parsed again.
+     *
+     */
+    std::vector<StateMachine> stateMachines() const;
+
+    /**
+     * Returns the command line of the search.
+     *
+     */
+    std::string commandLine() const;
+
+    /**
+     * Unmap the hit store file.
+     *
+     */
+    void close();
+
+  private:
+    /**
+     * Beginning of the hit store file.
+     *
+     */
+    struct Header
+    {
+      char     magic[8];
+      uint64_t hits;
+      uint64_t records;
+      uint64_t patterns;
+      uint64_t namesSize;
+      uint64_t dictionarySize;
+      uint64_t commandLineSize;
+    };
+
+    char           *_data           = nullptr;
+    size_t          _size           = 0;
+    const Header   *_header         = nullptr;
+    const uint32_t *_recordIds      = nullptr;
+    const uint32_t *_patternIds     = nullptr;
+    const uint64_t *_begins         = nullptr;
+    const uint64_t *_ends           = nullptr;
+    const uint32_t *_mismatches     = nullptr;
+    const uint64_t *_nameOffsets    = nullptr;
+    const char     *_names          = nullptr;
+    const uint64_t *_patternOffsets = nullptr;
+    const char     *_dictionary     = nullptr;
+    const char     *_strands        = nullptr;
+    const uint16_t *_minimums       = nullptr;
+    const char     *_commandLine    = nullptr;
+
+    friend class HitStoreSink;
+};
+
+/**
+ * Sink writing a hit store file. The sequences are never held, the columns are kept in memory and the file is
+ * written when the search is finished.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class HitStoreSink final : public Sink
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param fileName Output file name to be created, without the extension.
+     * @param patterns Pattern table used in the search. It must outlive this object.
+     *
+     */
+    HitStoreSink(const std::string &fileName, const std::vector<StateMachine> &patterns);
+
+    /**
+     * Keep the command line, to be stored with the hits.
+     *
+     */
+    void createHeader(const std::string &commandLine);
+
+    /**
+     * Append the hits of a sequence gene to the columns.
+     *
+     */
+    void appendGene(const std::string &geneName, const std::string &recordName, size_t offset,
+      const GeneSource &geneSource, const std::vector<PositionToMark> &positions, const std::vector<HIT> &hit);
+
+    /**
+     * Write the hit store file. A HitStoreException is fired if it cannot be written.
+     *
+     */
+    void createFooter(size_t numberOfElements);
+
+  private:
+    std::string                      _fileName;
+    const std::vector<StateMachine> &_patterns;
+    std::string                      _commandLine;
+    std::vector<uint32_t>            _recordIds;
+    std::vector<uint32_t>            _patternIds;
+    std::vector<uint64_t>            _begins;
+    std::vector<uint64_t>            _ends;
+    std::vector<uint32_t>            _mismatches;
+    std::vector<uint64_t>            _nameOffsets;
+    std::string                      _names;
+};
+
+#endif
@@ -0,0 +1,46 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "htmlsink.h"
+
+HtmlSink::HtmlSink(const std::string &fileName, const std::vector<StateMachine> &patterns) :
+  _summary(fileName, patterns), _output(fileName)
+{
+}
+
+bool HtmlSink::needsMarks() const
+{
+  return true;
+}
+
+void HtmlSink::createHeader(const std::string &commandLine)
+{
+  _output.createHeader();
+  _summary.createHeader(commandLine);
+}
+
+void HtmlSink::appendGene(const std::string &geneName, const std::string &, size_t, const GeneSource &geneSource,
+  const std::vector<PositionToMark> &positions, const std::vector<HIT> &hit)
+{
+  _summary.appendGene(geneName, hit);
+  _output.appendGene(geneName, geneSource, positions);
+}
+
+void HtmlSink::createFooter(size_t numberOfElements)
+{
+  _summary.createFooter(numberOfElements);
+  _output.createFooter();
+}
@@ -0,0 +1,72 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef HTMLSINK_H
+#define HTMLSINK_H
+
+#include "sink.h"
+#include "output.h"
+#include "summary.h"
+
+/**
+ * Sink writing the HTML files: the sequence genes with the matches highlighted, and the summary of the matches.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class HtmlSink final : public Sink
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param fileName Output file name to be created, without the extension.
+     * @param patterns Pattern table used to find the state machine of each hit. It must outlive this object.
+     *
+     */
+    HtmlSink(const std::string &fileName, const std::vector<StateMachine> &patterns);
+
+    /**
+     * The sequences are written with the matches highlighted, so the marks are needed.
+     *
+     */
+    bool needsMarks() const;
+
+    /**
+     * Create the beginning of both HTML files.
+     *
+     */
+    void createHeader(const std::string &commandLine);
+
+    /**
+     * Append the sequence gene to the output and its matches to the summary.
+     *
+     */
+    void appendGene(const std::string &geneName, const std::string &recordName, size_t offset,
+      const GeneSource &geneSource, const std::vector<PositionToMark> &positions, const std::vector<HIT> &hit);
+
+    /**
+     * Finalize both HTML files.
+     *
+     */
+    void createFooter(size_t numberOfElements);
+
+  private:
+    Summary _summary;
+    Output  _output;
+};
+
+#endif
@@ -16,107 +16,834 @@
  */
 #include "hunt.h"
 
-#include <fstream>
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <thread>
+#include <future>
+#include <exception>
 
-HunT::HunT(size_t maxMismatch) : _maxMismatch(maxMismatch)
+#include "pipeline.h"
+
+/**
+ * Sort the marks appended after the from position into the sorted marks before them. The matches of a state machine
+ * only overlap the few matches before them, so the marks are moved only a few positions back.
+ *
+ */
+static
+void insertSorted(std::vector<PositionToMark> &marks, size_t from)
+{
+  for (size_t i = std::max<size_t>(from, 1); i < marks.size(); ++i) {
+    const PositionToMark mark = marks[i];
+
+    size_t j = i;
+    for (; j > 0 && PositionToMark::before(mark, marks[j - 1]); --j)
+      marks[j] = marks[j - 1];
+    marks[j] = mark;
+  }
+}
+
+const size_t HunT::NONE;
+
+HunT::HunT(size_t maxMismatch) : _maxMismatch(maxMismatch), _planner(maxMismatch), _automaton(maxMismatch),
+  _seedFilter(maxMismatch)
 {
 }
 
 void HunT::addStateMachine(const StateMachine &state)
+{
+  const size_t sm = _states.size();
+
+  addState(state, NONE);
+  _groups.push_back(Group { sm, NONE, false, SimdFilter(state, _maxMismatch), PackedMatcher(state, _maxMismatch),
+    SkipMatcher(state), Planner::Plan() });
+  _maxStates = std::max(_maxStates, state.size());
+
+  compile(_groups.back());
+}
+
+void HunT::addPattern(const std::string &label, const std::string &pattern, uint16_t minNumberOfPatterns)
+{
+  const StateMachine forward(label, pattern, minNumberOfPatterns, '+');
+  const StateMachine reverse    = forward.reverseComplement();
+  const bool         palindrome = forward.isPalindrome();
+  const size_t       sm         = _states.size();
+
+  addState(forward, palindrome ? sm + 1 : NONE);
+  addState(reverse, NONE);
+
+  if (palindrome)
+    _groups.push_back(Group { sm, sm + 1, true, SimdFilter(forward, _maxMismatch),
+      PackedMatcher(forward, _maxMismatch), SkipMatcher(forward), Planner::Plan() });
+  else
+    _groups.push_back(Group { sm, sm + 1, false, SimdFilter(forward, reverse, _maxMismatch),
+      PackedMatcher(forward, reverse, _maxMismatch), SkipMatcher(forward, reverse), Planner::Plan() });
+
+  _maxStates = std::max(_maxStates, forward.size());
+
+  compile(_groups.back());
+}
+
+void HunT::addState(const StateMachine &state, size_t mirror)
 {
   _states.push_back(state);
+  _mirrors.push_back(mirror);
+
+  if (ShortMatcher::supports(state)) {
+    _verifiers.push_back(_shortMatchers.size());
+    _shortMatchers.push_back(ShortMatcher(state, _maxMismatch));
+  }
+  else
+    _verifiers.push_back(NONE);
+}
+
+void HunT::compile(Group &group)
+{
+  const StateMachine &forward = _states.at(group.forward);
+  const bool          both    = group.reverse != NONE && !group.palindrome;
+
+  if (both)
+    group.plan = _planner.plan(forward, _states.at(group.reverse));
+  else
+    group.plan = _planner.plan(forward);
+
+  // The seed filter is forced only on the state machines it cannot miss matches of.
+  if (_seeded) {
+    double cost = _planner.cost(Planner::Engine::SEEDED, forward);
+    if (both)
+      cost += _planner.cost(Planner::Engine::SEEDED, _states.at(group.reverse));
+
+    if (cost < std::numeric_limits<double>::infinity())
+      group.plan = Planner::Plan { Planner::Engine::SEEDED, cost };
+  }
+
+  if (forward.size() == 0)
+    return;
+
+  // The reverse strand of a palindromic pattern is never matched, so it is not compiled.
+  if (group.plan.engine == Planner::Engine::BIT_PARALLEL) {
+    _automaton.add(forward, group.forward);
+    if (both)
+      _automaton.add(_states.at(group.reverse), group.reverse);
+  }
+  else if (group.plan.engine == Planner::Engine::SEEDED) {
+    _seedFilter.add(forward, group.forward);
+    if (both)
+      _seedFilter.add(_states.at(group.reverse), group.reverse);
+  }
+}
+
+const std::vector<StateMachine> &HunT::stateMachines() const
+{
+  return _states;
+}
+
+void HunT::setChunkSize(size_t chunkSize)
+{
+  _chunkSize = chunkSize;
+}
+
+void HunT::setThreads(size_t threads)
+{
+  _threads = threads > 0 ? threads : 1;
+}
+
+void HunT::setPacked(bool packed)
+{
+  _packed = packed;
+}
+
+void HunT::setSimdKernel(SimdFilter::Kernel kernel)
+{
+  _kernel = kernel;
+}
+
+void HunT::setSeedFilter(bool seeded)
+{
+  if (_seeded == seeded)
+    return;
+
+  // The plans change, so the shared engines are compiled again.
+  _seeded     = seeded;
+  _automaton  = ShiftAnd(_maxMismatch);
+  _seedFilter = SeedFilter(_maxMismatch);
+  for (auto &group : _groups)
+    compile(group);
+}
+
+void HunT::setMode(Mode mode)
+{
+  _mode = mode;
+}
+
+void HunT::setOutputQueue(size_t capacity)
+{
+  _outputQueue = capacity;
+}
+
+void HunT::setRegions(const std::vector<std::string> &regions)
+{
+  _regions = regions;
 }
 
-void HunT::execute(const std::string &geneFile, const std::function<void(const std::string &, const std::string &,
-  const std::vector<PositionToMark> &, const std::vector<HIT> &)> &callback) const
+void HunT::explain(std::ostream &out) const
 {
-  std::ifstream is;
+  out << "label\tstrands\tstates\tengine\tcost" << std::endl;
+  for (auto &group : _groups) {
+    const StateMachine &stateMachine = _states.at(group.forward);
 
-  is.open(geneFile);
+    out << stateMachine.label() << '\t' << stateMachine.strand();
+    if (group.reverse != NONE)
+      out << _states.at(group.reverse).strand() << (group.palindrome ? " (palindrome)" : "");
 
-  if (!is.is_open())
+    out << '\t' << stateMachine.size() << '\t';
+    if (isPacked())
+      out << "packed\t-" << std::endl;
+    else
+      out << Planner::name(group.plan.engine) << '\t' << std::fixed << std::setprecision(2) << group.plan.cost
+        << std::endl;
+  }
+}
+
+void HunT::execute(const std::string &geneFile, const Callback &callback) const
+{
+  Input input;
+
+  if (!input.reader.open(geneFile))
     throw HunTException("Problems to open the input file: " + geneFile);
 
-  std::string geneName, geneSequence;
-  while (!is.eof()) {
-    std::string line;
+  if (!_regions.empty())
+    findRegions(geneFile, input);
 
-    std::getline(is, line);
-    if (!line.empty() && line.at(0) == '>') {
-      if (!geneSequence.empty() && !geneSequence.empty())
-        processSequence(geneName, geneSequence, callback);
+  if (_threads > 1) {
+    executeParallel(input, callback);
+    return;
+  }
 
-      geneName = line;
-      geneSequence.clear();
+  Scratch scratch;
+  output([&] (const std::function<bool(Record &)> &consume) {
+    Record record;
+    while (read(input, record)) {
+      match(record, scratch);
+      if (!consume(record))
+        break;
     }
-    else
-      geneSequence += line;
+  }, [&] (Record &record) {
+    emit(record, callback);
+    release(input, record);
+  });
+}
+
+void HunT::findRegions(const std::string &geneFile, Input &input) const
+{
+  FastaIndex index;
+
+  if (!index.loadOrBuild(geneFile, input.reader))
+    throw HunTException("Cannot index the input file, its lines have different lengths: " + geneFile);
+
+  for (auto &text : _regions) {
+    FastaIndex::Region region;
+    if (!index.find(text, region))
+      throw HunTException("Invalid region: " + text);
+
+    input.regions.push_back(region);
   }
+}
 
-  if (!geneSequence.empty() && !geneSequence.empty())
-    processSequence(geneName, geneSequence, callback);
+void HunT::query(const FmIndex &index, const Callback &callback) const
+{
+  // Candidates of each record with matches, indexed by the state machine position.
+  std::map<size_t, std::vector<std::vector<size_t>>> begins;
+  std::vector<size_t> positions;
 
-  is.close();
+  auto search = [&] (size_t sm) {
+    positions.clear();
+    index.search(_states.at(sm), _maxMismatch, positions);
+
+    for (auto position : positions) {
+      const size_t record = index.record(position);
+      auto &recordBegins = begins[record];
+      if (recordBegins.empty())
+        recordBegins.resize(_states.size());
+
+      recordBegins.at(sm).push_back(position - index.begin(record));
+    }
+  };
+
+  // The matches of the reverse strand of a palindromic pattern are copied when the forward strand is verified.
+  for (auto &group : _groups) {
+    search(group.forward);
+    if (group.reverse != NONE && !group.palindrome)
+      search(group.reverse);
+  }
+
+  Scratch scratch;
+  output([&] (const std::function<bool(Record &)> &consume) {
+    Record record;
+    for (auto &entry : begins) {
+      record.geneName     = index.name(entry.first);
+      record.geneSequence = index.sequence(entry.first);
+
+      clear(scratch);
+      for (size_t sm = 0; sm < _states.size(); ++sm) {
+        auto &recordBegins = entry.second.at(sm);
+        std::sort(recordBegins.begin(), recordBegins.end());
+
+        for (auto idx : recordBegins)
+          verify(_states.at(sm), sm, record.geneSequence, idx, 0, scratch);
+      }
+
+      collect(record, scratch);
+      if (!consume(record))
+        break;
+    }
+  }, [&] (Record &record) {
+    emit(record, callback);
+  });
 }
 
-void HunT::processSequence(const std::string &geneName, const std::string &geneSequence, 
-  const std::function<void(const std::string &, const std::string &,
-  const std::vector<PositionToMark> &, const std::vector<HIT> &)> &callback) const
+template <typename Producer, typename Consumer>
+void HunT::output(const Producer &producer, const Consumer &consumer) const
 {
-  size_t sm = 0;
-  std::vector<HIT>            finalHit;
-  std::vector<PositionToMark> finalMarks;
+  if (_outputQueue == 0) {
+    producer([&] (Record &record) {
+      consumer(record);
+      return true;
+    });
+    return;
+  }
 
-  for (auto &stateMachine : _states) {
-    std::vector<HIT> hit;
-    std::vector<PositionToMark> marks;
-    for (size_t idx = 0; idx <= geneSequence.size() - stateMachine.size(); ++idx) {
-      std::vector<PositionToMark> tmpMarks;
-      size_t mismatchFound = 0;
-      stateMachine.restart(); 
+  // The records are released by the writer, in order, since the reader only gives back the memory before a position.
+  BoundedQueue<Record> finished(_outputQueue);
+  std::exception_ptr   error;
 
-      for (size_t idxState = idx; idx < geneSequence.size(); ++idxState) {
-        const State *currentState = stateMachine.nextState();
+  std::thread writerThread([&] {
+    try {
+      Record record;
+      while (finished.pop(record))
+        consumer(record);
+    }
+    catch (...) {
+      error = std::current_exception();
+    }
 
-        if (!currentState->contains(geneSequence.at(idxState))) {
-          if (currentState->acceptMismatch()) {
-            tmpMarks.push_back(PositionToMark(PositionToMark::Type::MISMATCH, idxState, sm));
-            ++mismatchFound;
+    finished.close();
+  });
 
-            if (mismatchFound > _maxMismatch)
-              break;
-          }
-          else
-            break;
-        }
+  try {
+    producer([&] (Record &record) {
+      return finished.push(record);
+    });
+  }
+  catch (...) {
+    finished.close();
+    writerThread.join();
+    throw;
+  }
 
-        if (currentState->isFinalState() && idxState != geneSequence.size()) {
-          marks.push_back(PositionToMark(PositionToMark::Type::BEGIN, idx, sm));
-          marks.push_back(PositionToMark(PositionToMark::Type::END, idxState, sm));
-          marks.insert(marks.end(), tmpMarks.begin(), tmpMarks.end());
+  finished.close();
+  writerThread.join();
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void HunT::executeParallel(Input &input, const Callback &callback) const
+{
+  BoundedQueue<std::pair<size_t, Record>> pending(_threads * 2);
+  ReorderBuffer<Record>                   done(_threads * 4);
 
-          hit.push_back(HIT(idx, idxState, mismatchFound, stateMachine));
+  std::mutex         errorMutex;
+  std::exception_ptr error;
+  auto fail = [&] {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    if (!error)
+      error = std::current_exception();
+
+    pending.close();
+    done.abort();
+  };
+
+  std::thread readerThread([&] {
+    try {
+      std::pair<size_t, Record> item;
+      while (read(input, item.second) && done.reserve(item.first)) {
+        if (!pending.push(item))
           break;
+      }
+    }
+    catch (...) {
+      fail();
+    }
+
+    done.finish();
+    pending.close();
+  });
+
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < _threads; ++i) {
+    workers.push_back(std::thread([&] {
+      try {
+        std::pair<size_t, Record> item;
+        Scratch                   scratch;
+        while (pending.pop(item)) {
+          match(item.second, scratch);
+          done.put(item.first, item.second);
+        }
+      }
+      catch (...) {
+        fail();
+      }
+    }));
+  }
+
+  try {
+    output([&] (const std::function<bool(Record &)> &consume) {
+      Record record;
+      while (done.next(record) && consume(record))
+        ;
+    }, [&] (Record &record) {
+      emit(record, callback);
+      release(input, record);
+    });
+  }
+  catch (...) {
+    fail();
+  }
+
+  readerThread.join();
+  for (auto &worker : workers)
+    worker.join();
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+bool HunT::read(Input &input, Record &record) const
+{
+  if (!input.regions.empty()) {
+    if (input.region == input.regions.size())
+      return false;
+
+    const FastaIndex::Region &region = input.regions.at(input.region++);
+
+    GeneSequence rawSequence;
+    if (!input.reader.slice(region.first, region.last, rawSequence))
+      throw HunTException("Region outside of the input file, the index may be outdated: " + region.name);
+
+    record.geneName   = ">" + region.name;
+    record.recordName = ">" + region.recordName;
+    record.offset     = region.offset;
+    if (_chunkSize != 0) {
+      record.geneSequence = rawSequence;
+      return true;
+    }
+
+    // The regions may overlap, so they are copied instead of compacted in place, to a buffer of the indexed length.
+    size_t rawOffset = 0;
+    record.buffer.resize(region.length);
+    record.geneSequence = GeneSequence(record.buffer.data(),
+      FastaReader::copyNucleotides(rawSequence, rawOffset, record.buffer.data(), region.length));
+  }
+  else if (_chunkSize != 0)
+    return input.reader.nextRaw(record.geneName, record.geneSequence);
+  else if (!input.reader.next(record.geneName, record.geneSequence))
+    return false;
+
+  // Once packed, the compacted record is not needed anymore.
+  if (isPacked()) {
+    record.packedSequence.pack(record.geneSequence);
+    if (input.regions.empty())
+      input.reader.release(record.geneSequence);
+    record.geneSequence = GeneSequence();
+    record.buffer       = std::vector<char>();
+  }
+
+  return true;
+}
+
+void HunT::release(Input &input, const Record &record) const
+{
+  // The regions are not read in the file order, so their memory is given back only when the file is closed.
+  if (!isPacked() && input.regions.empty())
+    input.reader.release(record.geneSequence);
+}
+
+bool HunT::isPacked() const
+{
+  return _packed && _chunkSize == 0;
+}
+
+void HunT::match(Record &record, Scratch &scratch) const
+{
+  clear(scratch);
+
+  // In exists mode the chunks are matched in windows, to stop as soon as all state machines have enough hits.
+  const size_t window = _mode == Mode::EXISTS ? EXISTS_WINDOW : static_cast<size_t>(-1);
+
+  if (isPacked()) {
+    scanParallel(record.packedSequence.size(), [&] (size_t begin, size_t end, Scratch &chunkScratch) {
+      for (size_t from = begin; from < end && !satisfied(chunkScratch);) {
+        const size_t to = end - from > window ? from + window : end;
+        scanPacked(record.packedSequence, from, to, chunkScratch);
+        from = to;
+      }
+    }, scratch);
+  }
+  else if (_chunkSize == 0) {
+    // Each chunk keeps the matches ending inside it, and also looks at the nucleotides before it, so the matches
+    // crossing the chunk boundary are found exactly once.
+    const GeneSequence &geneSequence = record.geneSequence;
+    const size_t overlap = _maxStates > 0 ? _maxStates - 1 : 0;
+
+    scanParallel(geneSequence.size(), [&] (size_t begin, size_t end, Scratch &chunkScratch) {
+      for (size_t from = begin; from < end && !satisfied(chunkScratch);) {
+        const size_t to        = end - from > window ? from + window : end;
+        const size_t viewBegin = from >= overlap ? from - overlap : 0;
+        scan(GeneSequence(geneSequence.data() + viewBegin, to - viewBegin), viewBegin, from - viewBegin,
+          chunkScratch);
+        from = to;
+      }
+    }, scratch);
+  }
+  else {
+    const size_t overlap = _maxStates > 0 ? _maxStates - 1 : 0;
+    std::string &buffer = scratch.buffer;
+    buffer.resize(overlap + _chunkSize);
+
+    size_t rawOffset = 0, carried = 0, offset = 0, length;
+    while (!satisfied(scratch) &&
+      (length = FastaReader::copyNucleotides(record.geneSequence, rawOffset, &buffer[carried], _chunkSize)) > 0) {
+      const size_t used = carried + length;
+      scan(GeneSequence(buffer.data(), used), offset, carried, scratch);
+
+      // Carry the end of the chunk, so the matches crossing to the next chunk are found there.
+      const size_t keep = std::min(overlap, used);
+      std::copy(buffer.begin() + (used - keep), buffer.begin() + used, buffer.begin());
+      offset += used - keep;
+      carried = keep;
+    }
+  }
+
+  collect(record, scratch);
+}
+
+void HunT::collect(Record &record, Scratch &scratch) const
+{
+  const PatternMarks  &marks = scratch.marks;
+  std::vector<size_t> &heads = scratch.heads;
+  std::vector<size_t> &heap  = scratch.heap;
+
+  record.marks.clear();
+  record.hit.clear();
+  heads.assign(_states.size(), 0);
+  heap.clear();
+
+  size_t total = 0;
+  for (size_t sm = 0; sm < _states.size(); ++sm) {
+    if (_states.at(sm).checkNumberOfPatterns(scratch.hit.at(sm))) {
+      record.hit.insert(record.hit.end(), scratch.hit.at(sm).begin(), scratch.hit.at(sm).end());
+      if (!marks.at(sm).empty()) {
+        heap.push_back(sm);
+        total += marks.at(sm).size();
+      }
+    }
+  }
+
+  // K-way merge of the marks of each state machine, the equal marks keep the state machine order.
+  auto after = [&] (size_t sm1, size_t sm2) -> bool {
+    const PositionToMark &p1 = marks[sm1][heads[sm1]];
+    const PositionToMark &p2 = marks[sm2][heads[sm2]];
+    if (PositionToMark::before(p2, p1))
+      return true;
+
+    return !PositionToMark::before(p1, p2) && sm2 < sm1;
+  };
+
+  record.marks.reserve(total);
+  std::make_heap(heap.begin(), heap.end(), after);
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), after);
+
+    const size_t sm = heap.back();
+    record.marks.push_back(marks[sm][heads[sm]]);
+    if (++heads[sm] < marks[sm].size())
+      std::push_heap(heap.begin(), heap.end(), after);
+    else
+      heap.pop_back();
+  }
+}
+
+bool HunT::satisfied(size_t sm, const Scratch &scratch) const
+{
+  const std::vector<HIT> &hit = scratch.hit.at(sm);
+  return _mode == Mode::EXISTS && !hit.empty() && _states.at(sm).checkNumberOfPatterns(hit);
+}
+
+bool HunT::satisfied(const Scratch &scratch) const
+{
+  if (_mode != Mode::EXISTS)
+    return false;
+
+  for (size_t sm = 0; sm < _states.size(); ++sm) {
+    if (_states.at(sm).size() > 0 && !satisfied(sm, scratch))
+      return false;
+  }
+
+  return true;
+}
+
+void HunT::clear(Scratch &scratch) const
+{
+  scratch.hit.resize(_states.size());
+  scratch.marks.resize(_states.size());
+  for (size_t sm = 0; sm < _states.size(); ++sm) {
+    scratch.hit[sm].clear();
+    scratch.marks[sm].clear();
+  }
+}
+
+void HunT::emit(const Record &record, const Callback &callback) const
+{
+  if (record.hit.empty())
+    return;
+
+  const std::string &recordName = record.recordName.empty() ? record.geneName : record.recordName;
+
+  if (isPacked())
+    callback(record.geneName, recordName, record.offset, PackedGeneSource(record.packedSequence), record.marks,
+      record.hit);
+  else if (_chunkSize == 0)
+    callback(record.geneName, recordName, record.offset, BufferedGeneSource(record.geneSequence), record.marks,
+      record.hit);
+  else
+    callback(record.geneName, recordName, record.offset, StreamedGeneSource(record.geneSequence, _chunkSize),
+      record.marks, record.hit);
+}
+
+template <typename Work>
+void HunT::scanParallel(size_t size, const Work &work, Scratch &scratch) const
+{
+  const size_t chunks = std::min(_threads, size / MIN_PARALLEL_CHUNK);
+
+  if (chunks <= 1) {
+    work(0, size, scratch);
+    return;
+  }
+
+  while (scratch.chunks.size() < chunks)
+    scratch.chunks.push_back(std::unique_ptr<Scratch>(new Scratch()));
+
+  std::vector<std::future<void>> futures;
+  for (size_t c = 0; c < chunks; ++c) {
+    const size_t begin = size * c / chunks;
+    const size_t end   = size * (c + 1) / chunks;
+    Scratch &chunkScratch = *scratch.chunks.at(c);
+
+    clear(chunkScratch);
+    auto chunkWork = [&, begin, end] {
+      work(begin, end, chunkScratch);
+    };
+
+    if (c + 1 < chunks)
+      futures.push_back(std::async(std::launch::async, chunkWork));
+    else
+      chunkWork();
+  }
+
+  for (auto &future : futures)
+    future.get();
+
+  // The matches ending in a chunk may begin in the chunk before it, so the marks are sorted again.
+  for (size_t sm = 0; sm < _states.size(); ++sm) {
+    for (size_t c = 0; c < chunks; ++c) {
+      const Scratch &chunkScratch = *scratch.chunks.at(c);
+      const size_t   from         = scratch.marks.at(sm).size();
+
+      scratch.hit.at(sm).insert(scratch.hit.at(sm).end(), chunkScratch.hit.at(sm).begin(),
+        chunkScratch.hit.at(sm).end());
+      scratch.marks.at(sm).insert(scratch.marks.at(sm).end(), chunkScratch.marks.at(sm).begin(),
+        chunkScratch.marks.at(sm).end());
+      insertSorted(scratch.marks.at(sm), from);
+    }
+  }
+}
+
+void HunT::scan(const GeneSequence &geneSequence, size_t offset, size_t from, Scratch &scratch) const
+{
+  std::vector<std::vector<size_t>> &begins = scratch.begins;
+  begins.resize(_states.size());
+  for (auto &patternBegins : begins)
+    patternBegins.clear();
+
+  // Each state machine is compiled in at most one of the shared engines, so their begins do not mix.
+  _seedFilter.search(geneSequence, begins, scratch.seedBegins, scratch.states);
+  if (!_automaton.empty())
+    _automaton.search(geneSequence, begins, scratch.states);
+
+  std::vector<size_t> &candidates        = scratch.candidates;
+  std::vector<size_t> &reverseCandidates = scratch.reverseCandidates;
+  for (auto &group : _groups) {
+    const StateMachine &stateMachine = _states.at(group.forward);
+    const size_t        reverse      = group.palindrome ? NONE : group.reverse;
+    if (stateMachine.size() == 0 || geneSequence.size() < stateMachine.size() ||
+      (satisfied(group.forward, scratch) && (reverse == NONE || satisfied(reverse, scratch))))
+      continue;
+
+    const size_t first = from >= stateMachine.size() ? from - stateMachine.size() + 1 : 0;
+    const size_t last  = geneSequence.size() - stateMachine.size() + 1;
+
+    if (group.plan.engine == Planner::Engine::NAIVE) {
+      for (size_t idx = first; idx < last; ++idx) {
+        verify(stateMachine, group.forward, geneSequence, idx, offset, scratch);
+        if (reverse != NONE)
+          verify(_states.at(reverse), reverse, geneSequence, idx, offset, scratch);
+      }
+    }
+    else if (group.plan.engine == Planner::Engine::BIT_PARALLEL || group.plan.engine == Planner::Engine::SEEDED) {
+      for (auto idx : begins.at(group.forward)) {
+        if (idx + stateMachine.size() > from)
+          verify(stateMachine, group.forward, geneSequence, idx, offset, scratch);
+      }
+
+      if (reverse != NONE) {
+        for (auto idx : begins.at(reverse)) {
+          if (idx + stateMachine.size() > from)
+            verify(_states.at(reverse), reverse, geneSequence, idx, offset, scratch);
         }
       }
     }
+    else {
+      // The filter checks both strands in the same pass over the gene sequence, the skip search in one pass each.
+      candidates.clear();
+      reverseCandidates.clear();
+      if (group.plan.engine == Planner::Engine::SKIP) {
+        if (reverse != NONE)
+          group.skipMatcher.search(geneSequence, first, last, candidates, reverseCandidates);
+        else
+          group.skipMatcher.search(geneSequence, first, last, candidates);
+      }
+      else if (reverse != NONE)
+        group.filter.search(geneSequence, first, last, candidates, reverseCandidates, _kernel);
+      else
+        group.filter.search(geneSequence, first, last, candidates, _kernel);
 
-    if (stateMachine.checkNumberOfPatterns(hit)) {
-      finalMarks.insert(finalMarks.end(), marks.begin(), marks.end());
-      finalHit.insert(finalHit.end(), hit.begin(), hit.end());
+      for (auto idx : candidates)
+        verify(stateMachine, group.forward, geneSequence, idx, offset, scratch);
+      for (auto idx : reverseCandidates)
+        verify(_states.at(reverse), reverse, geneSequence, idx, offset, scratch);
     }
-    ++sm;
   }
+}
 
-  if (!finalHit.empty()) {
-    std::sort(finalMarks.begin(), finalMarks.end(), [] (const PositionToMark &p1,
-      const PositionToMark &p2) -> bool {
-      if (p1.position() == p2.position())
-        return p1.type() < p2.type();
+void HunT::scanPacked(const PackedSequence &packedSequence, size_t from, size_t to, Scratch &scratch) const
+{
+  std::vector<size_t> &begins        = scratch.candidates;
+  std::vector<size_t> &reverseBegins = scratch.reverseCandidates;
+  std::string         &window        = scratch.window;
+  window.resize(_maxStates);
 
-      return p1.position() < p2.position();
-    });
+  // The candidates are verified against the unpacked nucleotides, that may not be ACGT.
+  auto verifyAll = [&] (const std::vector<size_t> &smBegins, size_t sm) {
+    const StateMachine &stateMachine = _states.at(sm);
+    for (auto idx : smBegins) {
+      packedSequence.unpack(idx, stateMachine.size(), &window[0]);
+      verify(stateMachine, sm, GeneSequence(window.data(), stateMachine.size()), 0, idx, scratch);
+    }
+  };
+
+  for (auto &group : _groups) {
+    const size_t reverse = group.palindrome ? NONE : group.reverse;
+    if (_states.at(group.forward).size() == 0 ||
+      (satisfied(group.forward, scratch) && (reverse == NONE || satisfied(reverse, scratch))))
+      continue;
 
-    callback(geneName, geneSequence, finalMarks, finalHit);
+    // Both strands are matched in the same pass over the packed sequence.
+    begins.clear();
+    reverseBegins.clear();
+    if (reverse != NONE)
+      group.packedMatcher.search(packedSequence, from, to, begins, reverseBegins);
+    else
+      group.packedMatcher.search(packedSequence, from, to, begins);
+
+    verifyAll(begins, group.forward);
+    if (reverse != NONE)
+      verifyAll(reverseBegins, reverse);
+  }
+}
+
+void HunT::verify(const StateMachine &stateMachine, size_t sm, const GeneSequence &geneSequence, size_t idx,
+  size_t offset, Scratch &scratch) const
+{
+  std::vector<PositionToMark> &tmpMarks = scratch.tmpMarks;
+  size_t mismatchFound = 0;
+
+  tmpMarks.clear();
+  if (!satisfied(sm, scratch) && matchAt(stateMachine, geneSequence, idx, sm, tmpMarks, mismatchFound)) {
+    const size_t end = idx + stateMachine.size() - 1;
+    store(sm, offset + idx, offset + end, mismatchFound, offset, scratch);
+
+    // A palindromic pattern matches the same positions with the same mismatches on the reverse strand.
+    if (_mirrors.at(sm) != NONE)
+      store(_mirrors.at(sm), offset + idx, offset + end, mismatchFound, offset, scratch);
+  }
+}
+
+void HunT::store(size_t sm, size_t begin, size_t end, size_t mismatchFound, size_t offset, Scratch &scratch) const
+{
+  scratch.hit.at(sm).push_back(HIT(begin, end, mismatchFound, sm));
+
+  // Only the full mode writes the sequences, the other modes do not need the marks.
+  if (_mode != Mode::FULL)
+    return;
+
+  std::vector<PositionToMark> &marks = scratch.marks.at(sm);
+  const size_t from = marks.size();
+
+  marks.push_back(PositionToMark(PositionToMark::Type::BEGIN, begin, sm));
+  marks.push_back(PositionToMark(PositionToMark::Type::END, end, sm));
+  for (auto &mark : scratch.tmpMarks)
+    marks.push_back(PositionToMark(PositionToMark::Type::MISMATCH, offset + mark.position(), sm));
+  insertSorted(marks, from);
+}
+
+bool HunT::matchAt(const StateMachine &stateMachine, const GeneSequence &geneSequence, size_t idx, size_t sm,
+  std::vector<PositionToMark> &tmpMarks, size_t &mismatchFound) const
+{
+  if (_verifiers.at(sm) != NONE) {
+    uint32_t mismatches;
+    if (!_shortMatchers[_verifiers[sm]].match(geneSequence, idx, mismatches))
+      return false;
+
+    for (; mismatches != 0; mismatches &= mismatches - 1) {
+      tmpMarks.push_back(PositionToMark(PositionToMark::Type::MISMATCH, idx + __builtin_ctz(mismatches), sm));
+      ++mismatchFound;
+    }
+
+    return true;
   }
+
+  StateCursor cursor(stateMachine);
+
+  for (size_t idxState = idx; idxState < geneSequence.size(); ++idxState) {
+    const State *currentState = cursor.nextState();
+
+    if (!currentState->contains(geneSequence[idxState])) {
+      if (currentState->acceptMismatch()) {
+        tmpMarks.push_back(PositionToMark(PositionToMark::Type::MISMATCH, idxState, sm));
+        ++mismatchFound;
+
+        if (mismatchFound > _maxMismatch)
+          return false;
+      }
+      else
+        return false;
+    }
+
+    if (currentState->isFinalState())
+      return true;
+  }
+
+  return false;
 }
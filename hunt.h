@@ -18,8 +18,19 @@
 #define HUNT_H
 
 #include <functional>
+#include <ostream>
 
 #include "hit.h"
+#include "genesource.h"
+#include "fastaindex.h"
+#include "shiftand.h"
+#include "packedmatcher.h"
+#include "simdfilter.h"
+#include "skipmatcher.h"
+#include "shortmatcher.h"
+#include "seedfilter.h"
+#include "planner.h"
+#include "fmindex.h"
 
 /**
  * Exception fired when an error happens inside the HunT class.
@@ -65,6 +76,22 @@ class HunTException final : public std::exception
 class HunT final
 {
   public:
+    /**
+     * Callback fired for each gene sequence with matches: gene name, name of the record holding the gene sequence,
+     * position of the gene sequence in the record, gene sequence, positions to be marked and hits. The record name
+     * and the position only differ from the gene name and 0 when a region of the record is matched.
+     *
+     */
+    typedef std::function<void(const std::string &, const std::string &, size_t, const GeneSource &,
+      const std::vector<PositionToMark> &, const std::vector<HIT> &)> Callback;
+
+    /**
+     * What is found for each gene sequence: the hits and the marks to write the sequence (FULL), only the hits
+     * (COUNT), or only enough hits to tell which state machines pass their minimum number of hits (EXISTS).
+     *
+     */
+    enum class Mode { FULL, COUNT, EXISTS };
+
     /**
      * Constructor.
      *
@@ -74,13 +101,124 @@ class HunT final
     HunT(size_t maxMismatch);
 
     /**
-     * Add a new state machine to be used in the match algorithm.
+     * Add a new state machine to be used in the match algorithm. The engine it is matched with is chosen by the
+     * planner, from its states and the maximum number of mismatches.
      *
      * @param state New state machine to be used in the match algorithm.
      *
      */
     void addStateMachine(const StateMachine &state);
 
+    /**
+     * Add a pattern to be matched on both strands: its state machine for the '+' strand and the state machine of its
+     * reverse complement for the '-' strand are added, in this order. Both strands are checked in the same pass over
+     * the gene sequences, and when the pattern is its own reverse complement it is matched only once, each match
+     * being reported on both strands. A ParseException is fired if the pattern is not valid.
+     *
+     * @param label A name identification.
+     * @param pattern The pattern to be matched.
+     * @param minNumberOfPatterns Minimum number of matches on each strand to be considered a gene sequence found.
+     *
+     */
+    void addPattern(const std::string &label, const std::string &pattern, uint16_t minNumberOfPatterns);
+
+    /**
+     * Returns the pattern table: all added state machines, in the order they were added. The pattern id of each hit
+     * is a position in this table.
+     *
+     * @return The added state machines.
+     *
+     */
+    const std::vector<StateMachine> &stateMachines() const;
+
+    /**
+     * Enable the streaming mode. Instead of holding the whole gene sequence in memory, it will be matched in chunks,
+     * carrying the last nucleotides of a chunk to the next one so matches crossing the chunks are still found.
+     *
+     * @param chunkSize Number of nucleotides per chunk, or 0 to hold the whole gene sequence (default).
+     *
+     */
+    void setChunkSize(size_t chunkSize);
+
+    /**
+     * Set the number of threads used to match the gene sequences. With more than one thread, a reader thread feeds
+     * the gene sequences to a pool of workers, and the callback is still fired in the same order of the gene sequences
+     * in the file. Large gene sequences are also split in chunks matched in parallel.
+     *
+     * @param threads Number of matching threads (default 1).
+     *
+     */
+    void setThreads(size_t threads);
+
+    /**
+     * Enable the packed mode. Each gene sequence is packed with 2 bits per nucleotide as soon as it is read, and it
+     * is matched 32 positions at a time against the packed words. It is only used when the chunk size is 0.
+     *
+     * @param packed True to use the packed mode, false to match the characters (default).
+     *
+     */
+    void setPacked(bool packed);
+
+    /**
+     * Set the vector kernel used to filter the starting positions of the state machines that are too long for the
+     * bit-parallel matcher. By default the fastest kernel supported by the CPU is used.
+     *
+     * @param kernel The kernel to be used. It must be supported by the CPU.
+     *
+     */
+    void setSimdKernel(SimdFilter::Kernel kernel);
+
+    /**
+     * Enable the seed filter for all state machines. Each state machine is split in one seed more than the maximum
+     * number of mismatches, the seeds are searched exactly and only the positions around them are verified. The state
+     * machines with no more states than mismatches cannot be split, so they keep the engine chosen by the planner.
+     *
+     * @param seeded True to use the seed filter, false to use the engine chosen by the planner (default).
+     *
+     */
+    void setSeedFilter(bool seeded);
+
+    /**
+     * Set what is found for each gene sequence. Out of the full mode no marks are given to the callback, and in the
+     * exists mode a gene sequence stops being matched as soon as all state machines have enough hits, so the hits
+     * given to the callback are not all the hits of the gene sequence.
+     *
+     * @param mode What is found for each gene sequence (default Mode::FULL).
+     *
+     */
+    void setMode(Mode mode);
+
+    /**
+     * Fire the callback in a writer thread, so matching goes on while the matches are written. The matched gene
+     * sequences are moved to a queue, and matching waits while the queue is full. The callback is still fired in the
+     * same order of the gene sequences in the file, always from the same thread.
+     *
+     * @param capacity Maximum number of matched gene sequences waiting for the callback, or 0 to fire the callback in
+     *                 the calling thread (default).
+     *
+     */
+    void setOutputQueue(size_t capacity);
+
+    /**
+     * Restrict the match to some records or regions of the records, read directly from their position in the file.
+     * The positions are taken from the samtools .fai index next to the file, that is built when it does not exist.
+     *
+     * @param regions Regions given as "name", "name:begin" or "name:begin-end", with 1-based inclusive positions, or
+     *                empty to match all the records (default).
+     *
+     */
+    void setRegions(const std::vector<std::string> &regions);
+
+    /**
+     * Write the engine chosen for each added pattern and its estimated cost, in nucleotide comparisons per position
+     * of the gene sequence. It is the plan of a FASTA file scan, the packed mode matches all patterns with the packed
+     * matcher.
+     *
+     * @param out Stream receiving one line per pattern.
+     *
+     */
+    void explain(std::ostream &out) const;
+
     /**
      * Execute the match algorithm. It will open the file, parse it and for all the matches fire a callback, that can implement the logic to
      * store/show the found information.
@@ -89,21 +227,265 @@ class HunT final
      * @param callback Callback function that will receive the processed data.
      *
      */
-    void execute(const std::string &geneFile, const std::function<void(const std::string &, const std::string &,
-      const std::vector<PositionToMark> &, const std::vector<HIT> &)> &callback) const;
+    void execute(const std::string &geneFile, const Callback &callback) const;
+
+    /**
+     * Execute the match algorithm against an index, instead of scanning a FASTA file. Each state machine is
+     * searched in the index and only the positions found are verified, and the callback is fired in the same order of
+     * the gene sequences in the indexed file.
+     *
+     * @param index Index of the gene Fasta file.
+     * @param callback Callback function that will receive the processed data.
+     *
+     */
+    void query(const FmIndex &index, const Callback &callback) const;
 
   private:
+    /**
+     * A gene sequence read from the file, together with its matches. When only a region of a record is read, the
+     * record name and the position of the region in the record are kept as well.
+     *
+     */
+    struct Record
+    {
+      std::string                 geneName;
+      std::string                 recordName;
+      size_t                      offset = 0;
+      GeneSequence                geneSequence;
+      std::vector<char>           buffer;
+      PackedSequence              packedSequence;
+      std::vector<PositionToMark> marks;
+      std::vector<HIT>            hit;
+    };
+
+    /**
+     * The file being read, and the regions still to be read when the match is restricted to some regions.
+     *
+     */
+    struct Input
+    {
+      FastaReader                     reader;
+      std::vector<FastaIndex::Region> regions;
+      size_t                          region = 0;
+    };
+
+    /**
+     * Hits and marks found for each state machine, indexed by the state machine position. The marks of each state
+     * machine are kept sorted by position and type.
+     *
+     */
+    typedef std::vector<std::vector<HIT>>            PatternHits;
+    typedef std::vector<std::vector<PositionToMark>> PatternMarks;
+
+    /**
+     * Buffers owned by a matching thread and reused from one record to the next, so once they have grown, matching
+     * a record does not allocate memory unless it has hits. The chunks hold the buffers of the threads matching the
+     * pieces of a large record.
+     *
+     */
+    struct Scratch
+    {
+      PatternHits                           hit;
+      PatternMarks                          marks;
+      std::vector<std::vector<size_t>>      begins;
+      std::vector<std::vector<size_t>>      seedBegins;
+      std::vector<uint64_t>                 states;
+      std::vector<size_t>                   candidates;
+      std::vector<size_t>                   reverseCandidates;
+      std::vector<PositionToMark>           tmpMarks;
+      std::vector<size_t>                   heads;
+      std::vector<size_t>                   heap;
+      std::string                           buffer;
+      std::string                           window;
+      std::vector<std::unique_ptr<Scratch>> chunks;
+    };
+
+    /**
+     * State machines that are matched in the same pass: a single state machine, or both strands of a pattern. The
+     * reverse strand of a palindromic pattern is not matched, it receives a copy of the matches of the forward strand.
+     * The plan tells which engine matches the group when the gene sequence is not packed.
+     *
+     */
+    struct Group
+    {
+      size_t        forward;
+      size_t        reverse;
+      bool          palindrome;
+      SimdFilter    filter;
+      PackedMatcher packedMatcher;
+      SkipMatcher   skipMatcher;
+      Planner::Plan plan;
+    };
+
+    /**
+     * Position of a missing state machine.
+     *
+     */
+    static const size_t NONE = static_cast<size_t>(-1);
+
+    /**
+     * Minimum number of nucleotides matched by each thread when a gene sequence is split.
+     *
+     */
+    static const size_t MIN_PARALLEL_CHUNK = 1 << 20;
+
+    /**
+     * Number of positions matched between the checks for enough hits, in exists mode.
+     *
+     */
+    static const size_t EXISTS_WINDOW = 1 << 16;
+
     size_t _maxMismatch = 0;
-    std::vector<StateMachine> _states;
+    size_t _chunkSize   = 0;
+    size_t _threads     = 1;
+    size_t _maxStates   = 0;
+    size_t _outputQueue = 0;
+    bool   _packed      = false;
+    bool   _seeded      = false;
+    Mode   _mode        = Mode::FULL;
+    std::vector<StateMachine>  _states;
+    std::vector<Group>         _groups;
+    std::vector<size_t>        _mirrors;
+    std::vector<size_t>        _verifiers;
+    std::vector<ShortMatcher>  _shortMatchers;
+    SimdFilter::Kernel         _kernel = SimdFilter::best();
+    Planner                    _planner;
+    ShiftAnd                   _automaton;
+    SeedFilter                 _seedFilter;
+    std::vector<std::string>   _regions;
+
+    /**
+     * Helper to add a state machine to the pattern table, compiling its short matcher when it is short enough.
+     *
+     */
+    void addState(const StateMachine &state, size_t mirror);
+
+    /**
+     * Helper to choose the engine of a group and add its state machines to the engine, when it is shared by the
+     * groups.
+     *
+     */
+    void compile(Group &group);
+
+    /**
+     * Helper to read the next record or region, compacted or raw depending on the chunk size.
+     *
+     */
+    bool read(Input &input, Record &record) const;
+
+    /**
+     * Helper to give back the memory of a record after it was consumed.
+     *
+     */
+    void release(Input &input, const Record &record) const;
+
+    /**
+     * Helper to tell if the records are packed.
+     *
+     */
+    bool isPacked() const;
+
+    /**
+     * Helper to find the matches of a record.
+     *
+     */
+    void match(Record &record, Scratch &scratch) const;
+
+    /**
+     * Helper to keep the hits and marks of the state machines with enough hits in a record. The marks of each state
+     * machine are already sorted, so they are merged.
+     *
+     */
+    void collect(Record &record, Scratch &scratch) const;
+
+    /**
+     * Helper to tell if a state machine already has enough hits in exists mode, so it does not need to be matched.
+     *
+     */
+    bool satisfied(size_t sm, const Scratch &scratch) const;
 
     /**
-     * Helper to process a gene sequence.
+     * Helper to tell if all state machines already have enough hits in exists mode, so the match can stop.
+     *
+     */
+    bool satisfied(const Scratch &scratch) const;
+
+    /**
+     * Helper to empty the hits and marks of the buffers, keeping their memory.
+     *
+     */
+    void clear(Scratch &scratch) const;
+
+    /**
+     * Helper to fire the callback for a record with matches.
+     *
+     */
+    void emit(const Record &record, const Callback &callback) const;
+
+    /**
+     * Helper to consume the matched records in order, in the writer thread when there is an output queue. The
+     * producer receives the function that takes each record, moving it to the queue, and that returns false once the
+     * writer has stopped.
+     *
+     */
+    template <typename Producer, typename Consumer>
+    void output(const Producer &producer, const Consumer &consumer) const;
+
+    /**
+     * Helper to run the reader, the matching workers and the callback in parallel.
+     *
+     */
+    void executeParallel(Input &input, const Callback &callback) const;
+
+    /**
+     * Helper to find the regions to be read, loading or building the index of the file.
+     *
+     */
+    void findRegions(const std::string &geneFile, Input &input) const;
+
+    /**
+     * Helper to split the positions of a gene sequence in chunks that are matched by several threads when it is
+     * large enough. The work receives the range of positions of the chunk and the buffers where to store the matches.
+     *
+     */
+    template <typename Work>
+    void scanParallel(size_t size, const Work &work, Scratch &scratch) const;
+
+    /**
+     * Helper to find the matches of all state machines in a piece of a gene sequence. Only matches ending at or after
+     * the from position are stored, and all positions are moved by offset.
+     *
+     */
+    void scan(const GeneSequence &geneSequence, size_t offset, size_t from, Scratch &scratch) const;
+
+    /**
+     * Helper to find the matches of all state machines starting inside a range of positions of a packed sequence.
+     *
+     */
+    void scanPacked(const PackedSequence &packedSequence, size_t from, size_t to, Scratch &scratch) const;
+
+    /**
+     * Helper to verify a match of a state machine, storing its hit and marks. The positions are moved by offset.
+     *
+     */
+    void verify(const StateMachine &stateMachine, size_t sm, const GeneSequence &geneSequence, size_t idx,
+      size_t offset, Scratch &scratch) const;
+
+    /**
+     * Helper to store a match of a state machine, with the mismatches found by the last walk.
+     *
+     */
+    void store(size_t sm, size_t begin, size_t end, size_t mismatchFound, size_t offset, Scratch &scratch) const;
+
+    /**
+     * Helper to walk a state machine starting at a gene sequence position, counting the mismatches and storing
+     * where they happened. The short state machines are checked by their short matcher instead.
+     *
+     * @return True if the state machine reached the final state, otherwise false.
      *
      */
-    void processSequence(const std::string &geneName, const std::string &geneSequence, 
-      const std::function<void(const std::string &, const std::string &,
-      const std::vector<PositionToMark> &, const std::vector<HIT> &)> &callback) const;
-      
+    bool matchAt(const StateMachine &stateMachine, const GeneSequence &geneSequence, size_t idx, size_t sm,
+      std::vector<PositionToMark> &tmpMarks, size_t &mismatchFound) const;
 };
 
 #endif
@@ -18,77 +18,235 @@
 #include <getopt.h>
 
 #include <fstream>
+#include <memory>
 
 #include "hunt.h"
-#include "output.h"
-#include "summary.h"
+#include "htmlsink.h"
+#include "tabularsink.h"
+#include "countsummary.h"
+#include "hitstore.h"
+#include "renderer.h"
+#include "motiflibrary.h"
 
 static
 void printUsage(const char * const appName)
 {
   std::cerr << "Usage " << appName << " [ARGS]" << std::endl;
+  std::cerr << "      " << appName << " index --input-file=<file_name> --output-file=<index_file_name>" << std::endl;
+  std::cerr << "      " << appName << " render --hits=<hits_file_name> --output-file=<file_name> "
+    "[--input-file=<file_name>|--index=<index_file_name>] [--label=<label>] [--mismatch=[0..n]] "
+    "[--region=<name>[:begin[-end]]] [--format=<format>]" << std::endl;
   std::cerr << "\t--input-file=<file_name>" << std::endl;
+  std::cerr << "\t--index=<index_file_name>" << std::endl;
+  std::cerr << "\t--region=<name>[:begin[-end]]" << std::endl;
   std::cerr <<  "\t--output-file=<file_name>" << std::endl;
   std::cerr << "\t--search-type=[0|1]" << std::endl;
   std::cerr << "\t--pattern=<search_pattern>" << std::endl;
+  std::cerr << "\t--motif=<library_motif_name>" << std::endl;
   std::cerr << "\t--mismatch=[0..n]" << std::endl;
   std::cerr << "\t--pattern-min=[0..n]" << std::endl;
   std::cerr << "\t--label=<label>" << std::endl;
+  std::cerr << "\t--chunk-size=[0..n]" << std::endl;
+  std::cerr << "\t--threads=[1..n]" << std::endl;
+  std::cerr << "\t--output-queue=[0..n]" << std::endl;
+  std::cerr << "\t--packed" << std::endl;
+  std::cerr << "\t--simd=[scalar|sse4.2|avx2|avx512]" << std::endl;
+  std::cerr << "\t--seed-filter" << std::endl;
+  std::cerr << "\t--mode=[full|count|exists]" << std::endl;
+  std::cerr << "\t--format=[html|bed|gff3|tsv|hits]" << std::endl;
+  std::cerr << "\t--explain" << std::endl;
 
   exit(1);
 }
 
 static
-std::string createComplement(const std::string &pattern)
+bool validFormat(const std::string &format)
 {
-  std::string ret;
-  for (size_t i = pattern.size(); i > 0; --i) {
-    char ch = pattern.at(i - 1);
-    switch(ch) {
-      case 'A':
-        ret += 'T';
+  return format == "html" || format == "bed" || format == "gff3" || format == "tsv" || format == "hits";
+}
+
+static
+Sink *createSink(const std::string &format, const std::string &outputFile, const std::vector<StateMachine> &patterns)
+{
+  if (format == "bed")
+    return new BedSink(outputFile, patterns);
+  else if (format == "gff3")
+    return new Gff3Sink(outputFile, patterns);
+  else if (format == "tsv")
+    return new TsvSink(outputFile, patterns);
+  else if (format == "hits")
+    return new HitStoreSink(outputFile, patterns);
+
+  return new HtmlSink(outputFile, patterns);
+}
+
+static
+int buildIndex(int argc, char **argv, const char * const appName)
+{
+  int ch;
+  static struct option longopts[] = {
+    { "input-file" , required_argument, NULL, 'i' },
+    { "output-file", required_argument, NULL, 'o' },
+    { NULL         , 0                , NULL, 0   }
+  };
+
+  std::string inputFile, outputFile;
+  while ((ch = getopt_long(argc, argv, "i:o:", longopts, NULL)) != -1) {
+    switch (ch) {
+      case 'i':
+        inputFile = optarg;
       break;
-      case 'C':
-        ret += 'G';
+      case 'o':
+        outputFile = optarg;
       break;
-      case 'G':
-        ret += 'C';
+      default:
+        printUsage(appName);
+    }
+  }
+
+  if (inputFile.empty() || outputFile.empty())
+    printUsage(appName);
+
+  try {
+    FmIndex::build(inputFile, outputFile);
+  }
+  catch (FmIndexException &e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+static
+int render(int argc, char **argv, const char * const appName)
+{
+  int ch;
+  static struct option longopts[] = {
+    { "hits"       , required_argument, NULL, 'H' },
+    { "input-file" , required_argument, NULL, 'i' },
+    { "index"      , required_argument, NULL, 'x' },
+    { "output-file", required_argument, NULL, 'o' },
+    { "label"      , required_argument, NULL, 'l' },
+    { "mismatch"   , required_argument, NULL, 'm' },
+    { "region"     , required_argument, NULL, 'r' },
+    { "format"     , required_argument, NULL, 'f' },
+    { NULL         , 0                , NULL, 0   }
+  };
+
+  std::string hitsFile, inputFile, indexFile, outputFile;
+  std::string format = "html";
+
+  std::vector<std::string> labels;
+  std::vector<std::string> regions;
+  size_t maxMismatch = static_cast<size_t>(-1);
+  while ((ch = getopt_long(argc, argv, "H:i:x:o:l:m:r:f:", longopts, NULL)) != -1) {
+    switch (ch) {
+      case 'H':
+        hitsFile = optarg;
+      break;
+      case 'i':
+        inputFile = optarg;
       break;
-      case 'T':
-        ret += 'A';
+      case 'x':
+        indexFile = optarg;
       break;
-      case '(':
-        ret += ')';
+      case 'o':
+        outputFile = optarg;
       break;
-      case ')':
-        ret += '(';
+      case 'l':
+        labels.push_back(optarg);
       break;
-      case '[':
-        ret += ']';
+      case 'm':
+        maxMismatch = strtoull(optarg, NULL, 10);
       break;
-      case ']':
-        ret += '[';
+      case 'r':
+        regions.push_back(optarg);
       break;
-      case 'N':
-        ret += 'N';
+      case 'f':
+        format = optarg;
+        if (!validFormat(format))
+          printUsage(appName);
       break;
+      default:
+        printUsage(appName);
     }
   }
 
-  return ret;
+  if (hitsFile.empty() || outputFile.empty() || (!inputFile.empty() && !indexFile.empty()))
+    printUsage(appName);
+
+  HitStore store;
+  if (!store.open(hitsFile)) {
+    std::cerr << "ERROR: Problems to open the hits file: " << hitsFile << std::endl;
+    return 1;
+  }
+
+  try {
+    Renderer renderer(store);
+    renderer.setLabels(labels);
+    renderer.setMaxMismatch(maxMismatch);
+    renderer.setRegions(regions);
+
+    std::unique_ptr<Sink> sink(createSink(format, outputFile, renderer.stateMachines()));
+
+    // Only the HTML output writes the sequences, so only it needs the searched file.
+    if (sink->needsMarks() && inputFile.empty() && indexFile.empty()) {
+      std::cerr << "ERROR: The html format needs the --input-file or --index searched" << std::endl;
+      return 1;
+    }
+
+    FmIndex index;
+    if (!indexFile.empty() && !index.open(indexFile))
+      throw HitStoreException("Problems to open the index file: " + indexFile);
+
+    renderer.render(*sink, inputFile, indexFile.empty() ? nullptr : &index);
+  }
+  catch (HitStoreException &e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+  catch (HunTException &e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+  catch (ParseException &e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
 }
 
 int main(int argc, char **argv)
 {
+  if (argc > 1 && std::string(argv[1]) == "index")
+    return buildIndex(argc - 1, argv + 1, argv[0]);
+
+  if (argc > 1 && std::string(argv[1]) == "render")
+    return render(argc - 1, argv + 1, argv[0]);
+
   int ch;
   static struct option longopts[] = {
-    { "input-file" , required_argument, NULL, 'i' },
-    { "output-file", required_argument, NULL, 'o' },
-    { "pattern"    , required_argument, NULL, 'p' },
-    { "mismatch"   , required_argument, NULL, 'm' },
-    { "pattern-min", required_argument, NULL, 'n' },
-    { "label"      , required_argument, NULL, 'l' },
-    { NULL         , 0                , NULL, 0   }
+    { "input-file"  , required_argument, NULL, 'i' },
+    { "index"       , required_argument, NULL, 'x' },
+    { "region"      , required_argument, NULL, 'r' },
+    { "output-file" , required_argument, NULL, 'o' },
+    { "pattern"     , required_argument, NULL, 'p' },
+    { "motif"       , required_argument, NULL, 'L' },
+    { "mismatch"    , required_argument, NULL, 'm' },
+    { "pattern-min" , required_argument, NULL, 'n' },
+    { "label"       , required_argument, NULL, 'l' },
+    { "chunk-size"  , required_argument, NULL, 'c' },
+    { "threads"     , required_argument, NULL, 't' },
+    { "output-queue", required_argument, NULL, 'q' },
+    { "packed"      , no_argument      , NULL, 'P' },
+    { "simd"        , required_argument, NULL, 's' },
+    { "seed-filter" , no_argument      , NULL, 'S' },
+    { "mode"        , required_argument, NULL, 'M' },
+    { "format"      , required_argument, NULL, 'f' },
+    { "explain"     , no_argument      , NULL, 'E' },
+    { NULL          , 0                , NULL, 0   }
   };
 
   std::string commandLine;
@@ -96,14 +254,26 @@ int main(int argc, char **argv)
     commandLine += argv[i] + std::string(" ");
 
   char *appName = argv[0];
-  std::string inputFile, outputFile;
+  std::string inputFile, indexFile, outputFile, format;
 
   std::vector<std::string> patterns;
   std::vector<std::string> labels;
+  std::vector<std::string> regions;
   std::vector<uint16_t>    minNumberOfPatterns;
+
+  std::vector<const MotifLibrary::Motif *> motifs;
   uint16_t mismatchesAllowed = 0;
+  size_t   chunkSize         = 0;
+  size_t   threads           = 1;
+  size_t   outputQueue       = 16;
+  bool     packed            = false;
+  bool     seeded            = false;
+  bool     explain           = false;
+
+  SimdFilter::Kernel kernel = SimdFilter::best();
+  HunT::Mode         mode   = HunT::Mode::FULL;
 
-  while ((ch = getopt_long(argc, argv, "i:o:p:m:n:l:", longopts, NULL)) != -1) {
+  while ((ch = getopt_long(argc, argv, "i:x:r:o:p:L:m:n:l:c:t:q:Ps:SM:f:E", longopts, NULL)) != -1) {
     switch (ch) {
       case 'i':
         if (!inputFile.empty())
@@ -111,6 +281,15 @@ int main(int argc, char **argv)
 
         inputFile = optarg;
       break;
+      case 'x':
+        if (!indexFile.empty())
+          printUsage(appName);
+
+        indexFile = optarg;
+      break;
+      case 'r':
+        regions.push_back(optarg);
+      break;
       case 'o':
         if (!outputFile.empty())
           printUsage(appName);
@@ -120,6 +299,16 @@ int main(int argc, char **argv)
       case 'p':
         patterns.push_back(optarg);
       break;
+      case 'L':
+        motifs.push_back(MotifLibrary::find(optarg));
+        if (motifs.back() == nullptr) {
+          std::cerr << "ERROR: Unknown motif: " << optarg << ". The library motifs are:";
+          for (size_t i = 0; i < MotifLibrary::size(); ++i)
+            std::cerr << " " << MotifLibrary::at(i).name;
+          std::cerr << std::endl;
+          return 1;
+        }
+      break;
       case 'm':
         mismatchesAllowed = atoi(optarg);
       break;
@@ -129,23 +318,80 @@ int main(int argc, char **argv)
       case 'l':
         labels.push_back(optarg);
       break;
+      case 'c':
+        chunkSize = strtoull(optarg, NULL, 10);
+      break;
+      case 't':
+        threads = strtoull(optarg, NULL, 10);
+      break;
+      case 'q':
+        outputQueue = strtoull(optarg, NULL, 10);
+      break;
+      case 'P':
+        packed = true;
+      break;
+      case 'S':
+        seeded = true;
+      break;
+      case 'E':
+        explain = true;
+      break;
+      case 'M':
+        if (std::string(optarg) == "full")
+          mode = HunT::Mode::FULL;
+        else if (std::string(optarg) == "count")
+          mode = HunT::Mode::COUNT;
+        else if (std::string(optarg) == "exists")
+          mode = HunT::Mode::EXISTS;
+        else
+          printUsage(appName);
+      break;
+      case 'f':
+        format = optarg;
+        if (!validFormat(format))
+          printUsage(appName);
+      break;
+      case 's':
+        if (!SimdFilter::parse(optarg, kernel))
+          printUsage(appName);
+
+        if (!SimdFilter::supported(kernel)) {
+          std::cerr << "ERROR: SIMD kernel not supported by this CPU: " << optarg << std::endl;
+          return 1;
+        }
+      break;
       default:
         printUsage(appName);
      }
   }
 
-  if (patterns.empty() || inputFile.empty() || outputFile.empty())
+  // The plan is shown without matching, so it does not need the files.
+  if ((patterns.empty() && motifs.empty()) ||
+    (!explain && (inputFile.empty() == indexFile.empty() || outputFile.empty())))
     printUsage(appName);
 
   if (patterns.size() != minNumberOfPatterns.size() || patterns.size() != labels.size())
     printUsage(appName);
 
+  if (!regions.empty() && !indexFile.empty())
+    printUsage(appName);
+
+  // The count and exists modes only write the tab separated summary, so no other format can be asked.
+  if (mode != HunT::Mode::FULL && !format.empty())
+    printUsage(appName);
+
   HunT hunt(mismatchesAllowed);
+  hunt.setChunkSize(chunkSize);
+  hunt.setThreads(threads);
+  hunt.setOutputQueue(outputQueue);
+  hunt.setPacked(packed);
+  hunt.setSimdKernel(kernel);
+  hunt.setSeedFilter(seeded);
+  hunt.setRegions(regions);
 
   for (size_t i = 0; i < patterns.size(); ++i) {
     try {
-      hunt.addStateMachine(StateMachine(labels.at(i), patterns.at(i), minNumberOfPatterns.at(i), '+'));
-      hunt.addStateMachine(StateMachine(labels.at(i), createComplement(patterns.at(i)), minNumberOfPatterns.at(i), '-'));
+      hunt.addPattern(labels.at(i), patterns.at(i), minNumberOfPatterns.at(i));
     }
     catch (ParseException &e) {
       std::cerr << "ERROR: " << e.what() << std::endl;
@@ -153,32 +399,78 @@ int main(int argc, char **argv)
     }
   }
 
-  Summary summary(outputFile);
-  Output  output(outputFile);
+  // The library motifs are parsed at compile time, so they are always valid.
+  for (auto motif : motifs)
+    hunt.addPattern(motif->name, motif->pattern, 1);
+
+  if (explain) {
+    hunt.explain(std::cout);
+    return 0;
+  }
+
+  // Without a format the html page is written.
+  std::unique_ptr<Sink> sink;
+  try {
+    if (mode != HunT::Mode::FULL)
+      sink.reset(new CountSummary(outputFile, hunt.stateMachines(), mode == HunT::Mode::COUNT));
+    else
+      sink.reset(createSink(format, outputFile, hunt.stateMachines()));
+  }
+  catch (HunTException &e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+
+  // Without marks all hits are still found, like in count mode.
+  if (mode == HunT::Mode::FULL && !sink->needsMarks())
+    mode = HunT::Mode::COUNT;
+  hunt.setMode(mode);
 
-  output.createHeader();
-  summary.createHeader(commandLine);
+  sink->createHeader(commandLine);
 
   int ret = 0;
   size_t counter = 0;
+  auto callback = [&] (const std::string &geneName, const std::string &recordName, size_t offset,
+    const GeneSource &geneSource, const std::vector<PositionToMark> &positions, const std::vector<HIT> &hit) {
+    std::string name = geneName;
+    if (!name.empty())
+      name.erase(0, 1);
+
+    std::string record = recordName;
+    if (!record.empty())
+      record.erase(0, 1);
+
+    sink->appendGene(name, record, offset, geneSource, positions, hit);
+    ++counter;
+  };
+
   try {
-    hunt.execute(inputFile, [&] (const std::string &geneName, const std::string &geneSequence,
-      const std::vector<PositionToMark> &positions, const std::vector<HIT> &hit) {
-      std::string name = geneName;
-      if (!name.empty())
-        name.erase(0, 1);
-      summary.appendGene(name, hit);
-      output.appendGene(name, geneSequence, positions);
-      ++counter;
-    });
+    if (!indexFile.empty()) {
+      FmIndex index;
+      if (!index.open(indexFile))
+        throw HunTException("Problems to open the index file: " + indexFile);
+
+      hunt.query(index, callback);
+    }
+    else
+      hunt.execute(inputFile, callback);
   }
   catch (HunTException &e) {
     std::cerr << "ERROR: " << e.what() << std::endl;
     ret = 1;
   }
 
-  summary.createFooter(counter);
-  output.createFooter();
+  try {
+    sink->createFooter(counter);
+  }
+  catch (HitStoreException &e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    ret = 1;
+  }
+  catch (HunTException &e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    ret = 1;
+  }
 
   return ret;
 }
@@ -0,0 +1,89 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "motiflibrary.h"
+
+#include "shortmatcher.h"
+
+namespace {
+
+/**
+ * The motifs of the library. The restriction sites are cut only when they are exact, so their states do not accept
+ * mismatches.
+ *
+ */
+constexpr MotifLibrary::Motif MOTIFS[] = {
+  MotifLibrary::motif("EcoRI"         , "(GAATTC)"),
+  MotifLibrary::motif("BamHI"         , "(GGATCC)"),
+  MotifLibrary::motif("HindIII"       , "(AAGCTT)"),
+  MotifLibrary::motif("XhoI"          , "(CTCGAG)"),
+  MotifLibrary::motif("PstI"          , "(CTGCAG)"),
+  MotifLibrary::motif("SmaI"          , "(CCCGGG)"),
+  MotifLibrary::motif("KpnI"          , "(GGTACC)"),
+  MotifLibrary::motif("SacI"          , "(GAGCTC)"),
+  MotifLibrary::motif("XbaI"          , "(TCTAGA)"),
+  MotifLibrary::motif("SalI"          , "(GTCGAC)"),
+  MotifLibrary::motif("NcoI"          , "(CCATGG)"),
+  MotifLibrary::motif("NdeI"          , "(CATATG)"),
+  MotifLibrary::motif("NotI"          , "(GCGGCCGC)"),
+  MotifLibrary::motif("TATA-box"      , "TATA[AT]A[AT]"),
+  MotifLibrary::motif("Pribnow-box"   , "TATAAT"),
+  MotifLibrary::motif("-35-box"       , "TTGACA"),
+  MotifLibrary::motif("CAAT-box"      , "GG[CT]CAATCT"),
+  MotifLibrary::motif("GC-box"        , "GGGCGG"),
+  MotifLibrary::motif("E-box"         , "CANNTG"),
+  MotifLibrary::motif("Kozak"         , "GCC[AG]CC(ATG)G"),
+  MotifLibrary::motif("Shine-Dalgarno", "AGGAGG"),
+  MotifLibrary::motif("PolyA-signal"  , "AATAAA")
+};
+
+constexpr size_t NUMBER_OF_MOTIFS = sizeof(MOTIFS) / sizeof(MOTIFS[0]);
+
+/**
+ * Returns if the motifs from a position on are valid and short enough for the short matcher.
+ *
+ */
+constexpr bool valid(size_t idx)
+{
+  return idx == NUMBER_OF_MOTIFS || (MOTIFS[idx].states != MotifLibrary::INVALID && MOTIFS[idx].states > 0 &&
+    MOTIFS[idx].states <= ShortMatcher::MAX_STATES && valid(idx + 1));
+}
+
+static_assert(valid(0), "Invalid or too long pattern in the motif library");
+
+}
+
+const size_t MotifLibrary::INVALID;
+
+const MotifLibrary::Motif *MotifLibrary::find(const std::string &name)
+{
+  for (auto &motif : MOTIFS) {
+    if (name == motif.name)
+      return &motif;
+  }
+
+  return nullptr;
+}
+
+size_t MotifLibrary::size()
+{
+  return NUMBER_OF_MOTIFS;
+}
+
+const MotifLibrary::Motif &MotifLibrary::at(size_t idx)
+{
+  return MOTIFS[idx];
+}
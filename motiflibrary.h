@@ -0,0 +1,128 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef MOTIFLIBRARY_H
+#define MOTIFLIBRARY_H
+
+#include <string>
+
+/**
+ * A fixed library of well known motifs, built into the binary. The patterns are parsed at compile time, with the same
+ * syntax of the state machines, so a library with an invalid pattern, or with a pattern too long for the short
+ * matcher, does not compile.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class MotifLibrary final
+{
+  public:
+    /**
+     * A motif of the library: its name, used as label, its pattern and its number of states.
+     *
+     */
+    struct Motif
+    {
+      const char *name;
+      const char *pattern;
+      size_t      states;
+    };
+
+    /**
+     * Number of states of an invalid pattern.
+     *
+     */
+    static const size_t INVALID = static_cast<size_t>(-1);
+
+    /**
+     * Returns the number of states of a pattern, at compile time when the pattern is a constant.
+     *
+     * @param pattern The pattern to be parsed.
+     *
+     * @return The number of states, or INVALID if the pattern is not valid.
+     *
+     */
+    static constexpr size_t states(const char *pattern)
+    {
+      return states(pattern, false, false, false, 0);
+    }
+
+    /**
+     * Returns a motif, parsed at compile time when the name and the pattern are constants.
+     *
+     * @param name The motif name.
+     * @param pattern The motif pattern.
+     *
+     * @return The motif.
+     *
+     */
+    static constexpr Motif motif(const char *name, const char *pattern)
+    {
+      return Motif { name, pattern, states(pattern) };
+    }
+
+    /**
+     * Find a motif of the library.
+     *
+     * @param name The motif name.
+     *
+     * @return The motif, or nullptr if there is no motif with this name.
+     *
+     */
+    static const Motif *find(const std::string &name);
+
+    /**
+     * Returns the number of motifs in the library.
+     *
+     * @return The number of motifs.
+     *
+     */
+    static size_t size();
+
+    /**
+     * Returns a motif of the library.
+     *
+     * @param idx Motif position, from 0 to size() - 1.
+     *
+     * @return The motif.
+     *
+     */
+    static const Motif &at(size_t idx);
+
+  private:
+    /**
+     * Helper to parse the rest of a pattern, knowing if it is inside brackets or parenthesis, if there are nucleotides
+     * in the brackets and how many states were parsed.
+     *
+     */
+    static constexpr size_t states(const char *pattern, bool brackets, bool parenthesis, bool nucleotides,
+      size_t count)
+    {
+      return *pattern == '\0' ? count :
+        (*pattern == 'A' || *pattern == 'C' || *pattern == 'G' || *pattern == 'T') ?
+          (brackets ? states(pattern + 1, true, parenthesis, true, count) :
+            states(pattern + 1, false, parenthesis, false, count + 1)) :
+        *pattern == 'N' ? states(pattern + 1, brackets, parenthesis, false, count + 1) :
+        *pattern == '(' ? (brackets || parenthesis ? INVALID : states(pattern + 1, false, true, nucleotides, count)) :
+        *pattern == '[' ? (brackets ? INVALID : states(pattern + 1, true, parenthesis, nucleotides, count)) :
+        *pattern == ']' ? (!brackets || !nucleotides ? INVALID :
+          states(pattern + 1, false, parenthesis, false, count + 1)) :
+        *pattern == ')' ? (!parenthesis ? INVALID : states(pattern + 1, brackets, false, nucleotides, count)) :
+        INVALID;
+    }
+};
+
+#endif
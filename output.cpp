@@ -16,8 +16,9 @@
  */
 #include "output.h"
 
-Output::Output(const std::string &fileName)
+Output::Output(const std::string &fileName) : _buffer(BUFFER_SIZE)
 {
+  _os.rdbuf()->pubsetbuf(_buffer.data(), _buffer.size());
   _os.open(fileName + ".html");
 }
 
@@ -28,57 +29,77 @@ Output::~Output()
 
 void Output::createHeader()
 {
-  _os << "<html>" << std::endl;
-  _os << "  <style type=\"text/css\">" << std::endl;
-  _os << "    .pattern0 { color: darkblue; font-weight:bold; }\n" << std::endl;
-  _os << "    .pattern1 { color: lightblue; font-weight:bold; }\n" << std::endl;
-  _os << "    .pattern2 { color: darkgreen; font-weight:bold; }\n" << std::endl;
-  _os << "    .pattern3 { color: lightgreen; font-weight:bold; }\n" << std::endl;
-  _os << "    .pattern4 { color: darkred; font-weight:bold; }\n" << std::endl;
-  _os << "    .pattern5 { color: lightred; font-weight:bold; }\n" << std::endl;
-  _os << "    .pattern6 { color: darkbrown; font-weight:bold; }\n" << std::endl;
-  _os << "    .pattern7 { color: lightbrown; font-weight:bold; }" << std::endl;
-  _os << "    .gene {width:800px; word-wrap: break-word;}" << std::endl;
-  _os << "  </style>" << std::endl;
-  _os << "  <body>" << std::endl;
+  _os << "<html>" << '\n';
+  _os << "  <style type=\"text/css\">" << '\n';
+  _os << "    .pattern0 { color: darkblue; font-weight:bold; }\n" << '\n';
+  _os << "    .pattern1 { color: lightblue; font-weight:bold; }\n" << '\n';
+  _os << "    .pattern2 { color: darkgreen; font-weight:bold; }\n" << '\n';
+  _os << "    .pattern3 { color: lightgreen; font-weight:bold; }\n" << '\n';
+  _os << "    .pattern4 { color: darkred; font-weight:bold; }\n" << '\n';
+  _os << "    .pattern5 { color: lightred; font-weight:bold; }\n" << '\n';
+  _os << "    .pattern6 { color: darkbrown; font-weight:bold; }\n" << '\n';
+  _os << "    .pattern7 { color: lightbrown; font-weight:bold; }" << '\n';
+  _os << "    .gene {width:800px; word-wrap: break-word;}" << '\n';
+  _os << "  </style>" << '\n';
+  _os << "  <body>" << '\n';
 } 
 
-void Output::appendGene(const std::string &geneName, const std::string &geneSequence,
+void Output::appendGene(const std::string &geneName, const GeneSource &geneSource,
   const std::vector<PositionToMark> &positions)
 {
-  _os << "    <div class=\"gene\">" << std::endl;
-  _os << "      <pre>" << geneName << std::endl;
-  size_t currPosition = 0;
-  for (size_t i = 0; i < geneSequence.size(); ++i) {
-    while (currPosition < positions.size() && positions.at(currPosition).position() == i) {
-      if (positions.at(currPosition).type() == PositionToMark::Type::BEGIN)
-        _os << "<span class=\"pattern" << positions.at(currPosition).patternUsed() << "\">";
-      else if (positions.at(currPosition).type() == PositionToMark::Type::MISMATCH) {
-        _os << "<u>";
-        break;
+  _os << "    <div class=\"gene\">" << '\n';
+  _os << "      <pre>" << geneName << '\n';
+  auto currPosition = positions.begin();
+  const auto end    = positions.end();
+  size_t i = 0;
+  geneSource.read([&] (const GeneSequence &geneSequence) {
+    for (size_t chunkIdx = 0; chunkIdx < geneSequence.size();) {
+      // The nucleotides up to the next mark are written at once.
+      size_t span = geneSequence.size() - chunkIdx;
+      if (currPosition != end && currPosition->position() - i < span)
+        span = currPosition->position() - i;
+
+      if (span > 0) {
+        _os.write(geneSequence.data() + chunkIdx, span);
+        chunkIdx += span;
+        i        += span;
+        continue;
       }
-      else
-        break;
 
-      ++currPosition;
-    }
-    _os << geneSequence.at(i);
+      while (currPosition != end && currPosition->position() == i) {
+        if (currPosition->type() == PositionToMark::Type::BEGIN)
+          _os << "<span class=\"pattern" << currPosition->patternUsed() << "\">";
+        else if (currPosition->type() == PositionToMark::Type::MISMATCH) {
+          _os << "<u>";
+          break;
+        }
+        else
+          break;
+
+        ++currPosition;
+      }
+      _os << geneSequence[chunkIdx];
+
+      while (currPosition != end && currPosition->position() == i) {
+        if (currPosition->type() == PositionToMark::Type::MISMATCH)
+          _os << "</u>";
+        else if (currPosition->type() == PositionToMark::Type::END)
+          _os << "</span>";
+        else
+          break;
 
-    while (currPosition < positions.size() && positions.at(currPosition).position() == i) {
-      if (positions.at(currPosition).type() == PositionToMark::Type::MISMATCH)
-        _os << "</u>";
-      else if (positions.at(currPosition).type() == PositionToMark::Type::END)
-        _os << "</span>";
-      else
-        break;
+        ++currPosition;
+      }
 
-      ++currPosition;
+      ++chunkIdx;
+      ++i;
     }
-  }
-  _os << std::endl << "      </pre>" << std::endl << "    </div>" << std::endl;
+  });
+  _os << '\n' << "      </pre>" << '\n' << "    </div>" << '\n';
 }
 
 void Output::createFooter()
 {
-  _os << "  </body>" << std::endl << "</html>" << std::endl;
+  _os << "  </body>" << '\n' << "</html>" << '\n';
+  _os.flush();
 }
@@ -22,6 +22,7 @@
 #include <fstream>
 
 #include "hit.h"
+#include "genesource.h"
 
 /**
  * This class will create an HTML output highlighting all the matches found on a sequence gene.
@@ -56,11 +57,11 @@ class Output final
      * Append a new gene information for each sequence gene processed.
      *
      * @param geneName Processed sequence gene name.
-     * @param geneSequence Sequence of ACTG nucleotide used in the match.
+     * @param geneSource Sequence of ACTG nucleotide used in the match.
      * @param positions Postions where there where a pattern match or nucleotide mismatch.
      *
      */
-    void appendGene(const std::string &geneName, const std::string &geneSequence,
+    void appendGene(const std::string &geneName, const GeneSource &geneSource,
       const std::vector<PositionToMark> &positions);
 
     /**
@@ -70,8 +71,14 @@ class Output final
     void createFooter();
 
   private:
-    std::ofstream _os;
+    /**
+     * Size of the buffer used to write the file. It is only flushed when full and when the file is finished.
+     *
+     */
+    static const size_t BUFFER_SIZE = 1 << 20;
 
+    std::vector<char> _buffer;
+    std::ofstream     _os;
 };
 
 #endif
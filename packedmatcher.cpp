@@ -0,0 +1,164 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "packedmatcher.h"
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * The lowest bit of each packed nucleotide.
+ *
+ */
+const uint64_t EVEN = 0x5555555555555555ULL;
+
+}
+
+PackedMatcher::PackedMatcher(const StateMachine &stateMachine, size_t maxMismatch)
+{
+  compile(stateMachine, maxMismatch);
+}
+
+PackedMatcher::PackedMatcher(const StateMachine &stateMachine, const StateMachine &reverse, size_t maxMismatch)
+{
+  compile(stateMachine, maxMismatch);
+  compile(reverse, maxMismatch);
+}
+
+void PackedMatcher::compile(const StateMachine &stateMachine, size_t maxMismatch)
+{
+  const char nucleotides[] = { 'A', 'C', 'G', 'T' };
+
+  Strand strand;
+  size_t numberMismatchStates = 0;
+  for (size_t i = 0; i < stateMachine.size(); ++i) {
+    const State &state = stateMachine.state(i);
+
+    uint8_t classes = 0;
+    for (size_t code = 0; code < 4; ++code) {
+      if (state.contains(nucleotides[code]))
+        classes |= 1 << code;
+    }
+
+    strand.classes.push_back(classes);
+    strand.mismatch.push_back(state.acceptMismatch());
+    if (state.acceptMismatch())
+      ++numberMismatchStates;
+  }
+
+  // When all the states accepting mismatches can fail, there is no need to count them. When there are too many
+  // mismatches to be counted, the mismatches are not counted either, and all the candidates are verified. Without
+  // mismatches there is nothing to count, a failed state kills the position.
+  strand.maxMismatch = std::min(maxMismatch, numberMismatchStates);
+  if (strand.maxMismatch > 0 && strand.maxMismatch < numberMismatchStates) {
+    while ((size_t(1) << strand.planes) <= strand.maxMismatch)
+      ++strand.planes;
+
+    strand.countMismatches = strand.planes <= MAX_PLANES;
+  }
+
+  _strands.push_back(strand);
+}
+
+void PackedMatcher::search(const PackedSequence &packedSequence, size_t from, size_t to,
+  std::vector<size_t> &begins) const
+{
+  std::vector<size_t> *strandBegins[] = { &begins };
+  search(packedSequence, from, to, strandBegins, 1);
+}
+
+void PackedMatcher::search(const PackedSequence &packedSequence, size_t from, size_t to,
+  std::vector<size_t> &begins, std::vector<size_t> &reverseBegins) const
+{
+  std::vector<size_t> *strandBegins[] = { &begins, &reverseBegins };
+  search(packedSequence, from, to, strandBegins, _strands.size());
+}
+
+void PackedMatcher::search(const PackedSequence &packedSequence, size_t from, size_t to,
+  std::vector<size_t> *begins[], size_t strands) const
+{
+  const size_t size = _strands.front().classes.size();
+  if (packedSequence.size() < size)
+    return;
+
+  const size_t last = std::min(to, packedSequence.size() - size + 1);
+  for (size_t block = from; block < last; block += PackedSequence::NUCLEOTIDES_PER_WORD) {
+    const size_t starts = std::min(last - block, PackedSequence::NUCLEOTIDES_PER_WORD);
+    const uint64_t valid = starts == PackedSequence::NUCLEOTIDES_PER_WORD ? EVEN : EVEN & ((uint64_t(1) << (starts * 2)) - 1);
+
+    uint64_t alive[MAX_STRANDS];
+    uint64_t counters[MAX_STRANDS][MAX_PLANES] = {};
+    uint64_t anyAlive = 0;
+    for (size_t s = 0; s < strands; ++s) {
+      alive[s]  = valid;
+      anyAlive |= valid;
+    }
+
+    // Each packed word is loaded once and compared with the states of all the strands.
+    for (size_t i = 0; i < size && anyAlive; ++i) {
+      const uint64_t window = packedSequence.window(block + i);
+      const uint64_t lo  = window & EVEN;
+      const uint64_t hi  = (window >> 1) & EVEN;
+
+      anyAlive = 0;
+      for (size_t s = 0; s < strands; ++s) {
+        const Strand  &strand = _strands[s];
+        const uint8_t  cls    = strand.classes[i];
+
+        uint64_t match = 0;
+        if (cls & 1)
+          match |= ~lo & ~hi;
+        if (cls & 2)
+          match |= lo & ~hi;
+        if (cls & 4)
+          match |= ~lo & hi;
+        if (cls & 8)
+          match |= lo & hi;
+
+        const uint64_t failed = ~match & alive[s];
+        if (failed) {
+          if (!strand.mismatch[i] || strand.maxMismatch == 0)
+            alive[s] &= ~failed;
+          else if (strand.countMismatches) {
+            // Positions already at the maximum number of mismatches die, the others have their counter incremented.
+            uint64_t full = alive[s];
+            for (size_t p = 0; p < strand.planes; ++p)
+              full &= (strand.maxMismatch >> p) & 1 ? counters[s][p] : ~counters[s][p];
+
+            alive[s] &= ~(full & failed);
+
+            uint64_t carry = failed & alive[s];
+            for (size_t p = 0; p < strand.planes && carry; ++p) {
+              const uint64_t next = counters[s][p] & carry;
+              counters[s][p] ^= carry;
+              carry = next;
+            }
+          }
+        }
+
+        anyAlive |= alive[s];
+      }
+    }
+
+    for (size_t s = 0; s < strands; ++s) {
+      while (alive[s]) {
+        begins[s]->push_back(block + __builtin_ctzll(alive[s]) / 2);
+        alive[s] &= alive[s] - 1;
+      }
+    }
+  }
+}
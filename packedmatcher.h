@@ -0,0 +1,126 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef PACKEDMATCHER_H
+#define PACKEDMATCHER_H
+
+#include "statemachine.h"
+#include "packedsequence.h"
+
+/**
+ * Match a state machine against a packed sequence, checking 32 starting positions at once: each state is compared
+ * with a whole packed word, giving one bit per starting position, and the mismatches are added in bit-sliced
+ * counters. The characters that are not one of the ACGT nucleotides are compared as the A they are packed as, so
+ * the positions found are candidates that must still be verified against the unpacked sequence.
+ *
+ * The matcher can also be built for both strands of a pattern, comparing the states of the reverse complement with
+ * the same packed words loaded for the forward strand, so both strands are matched in a single pass.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class PackedMatcher final
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param stateMachine The state machine to be compiled. It must have at least one state.
+     * @param maxMismatch Maximum supported mismatches.
+     *
+     */
+    PackedMatcher(const StateMachine &stateMachine, size_t maxMismatch);
+
+    /**
+     * Constructor for both strands of a pattern.
+     *
+     * @param stateMachine The state machine of the forward strand. It must have at least one state.
+     * @param reverse The state machine of the reverse strand. It must have the same number of states.
+     * @param maxMismatch Maximum supported mismatches.
+     *
+     */
+    PackedMatcher(const StateMachine &stateMachine, const StateMachine &reverse, size_t maxMismatch);
+
+    /**
+     * Find the candidate matches starting inside a range of positions.
+     *
+     * @param packedSequence The packed sequence to be scanned.
+     * @param from First starting position to be checked.
+     * @param to Position after the last starting position to be checked.
+     * @param begins Vector that will receive the candidate starting positions, in ascending order.
+     *
+     */
+    void search(const PackedSequence &packedSequence, size_t from, size_t to, std::vector<size_t> &begins) const;
+
+    /**
+     * Find the candidate matches of each strand starting inside a range of positions. The matcher must have been
+     * built for both strands.
+     *
+     * @param packedSequence The packed sequence to be scanned.
+     * @param from First starting position to be checked.
+     * @param to Position after the last starting position to be checked.
+     * @param begins Vector that will receive the candidate starting positions of the forward strand, in ascending
+     *               order.
+     * @param reverseBegins Vector that will receive the candidate starting positions of the reverse strand, in
+     *                      ascending order.
+     *
+     */
+    void search(const PackedSequence &packedSequence, size_t from, size_t to, std::vector<size_t> &begins,
+      std::vector<size_t> &reverseBegins) const;
+
+  private:
+    /**
+     * Maximum number of bit-sliced counter planes, enough to count up to 255 mismatches.
+     *
+     */
+    static const size_t MAX_PLANES = 8;
+
+    /**
+     * Maximum number of strands matched in the same pass.
+     *
+     */
+    static const size_t MAX_STRANDS = 2;
+
+    /**
+     * The compiled states of a strand.
+     *
+     */
+    struct Strand
+    {
+      std::vector<uint8_t> classes;
+      std::vector<bool>    mismatch;
+      size_t               maxMismatch;
+      size_t               planes          = 0;
+      bool                 countMismatches = false;
+    };
+
+    std::vector<Strand> _strands;
+
+    /**
+     * Helper to compile the states of the state machine of a strand.
+     *
+     */
+    void compile(const StateMachine &stateMachine, size_t maxMismatch);
+
+    /**
+     * Helper to match the first strands, with one vector of candidates per strand.
+     *
+     */
+    void search(const PackedSequence &packedSequence, size_t from, size_t to, std::vector<size_t> *begins[],
+      size_t strands) const;
+};
+
+#endif
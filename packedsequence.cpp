@@ -0,0 +1,184 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "packedsequence.h"
+
+#include <algorithm>
+
+namespace {
+
+const uint8_t LOWER_CASE = 4;
+const uint8_t NONE       = 8;
+
+/**
+ * Code of each character, with LOWER_CASE set for the acgt nucleotides, or NONE for the characters that are not
+ * nucleotides.
+ *
+ */
+struct CodeTable
+{
+  uint8_t code[256];
+
+  CodeTable()
+  {
+    std::fill(code, code + 256, NONE);
+    code[static_cast<unsigned char>('A')] = 0;
+    code[static_cast<unsigned char>('C')] = 1;
+    code[static_cast<unsigned char>('G')] = 2;
+    code[static_cast<unsigned char>('T')] = 3;
+    code[static_cast<unsigned char>('a')] = LOWER_CASE | 0;
+    code[static_cast<unsigned char>('c')] = LOWER_CASE | 1;
+    code[static_cast<unsigned char>('g')] = LOWER_CASE | 2;
+    code[static_cast<unsigned char>('t')] = LOWER_CASE | 3;
+  }
+};
+
+const CodeTable codeTable;
+const char      nucleotides[]          = { 'A', 'C', 'G', 'T' };
+const char      lowerCaseNucleotides[] = { 'a', 'c', 'g', 't' };
+
+/**
+ * Returns the first range, or run, overlapping a piece that begins at a position: the last one beginning before it.
+ *
+ */
+template <typename T>
+typename std::vector<T>::const_iterator first(const std::vector<T> &ranges, size_t position)
+{
+  auto range = std::upper_bound(ranges.begin(), ranges.end(), position, [] (size_t p, const T &r) -> bool {
+    return p < r.position;
+  });
+
+  if (range != ranges.begin())
+    --range;
+
+  return range;
+}
+
+}
+
+const size_t PackedSequence::NUCLEOTIDES_PER_WORD;
+
+PackedSequence::PackedSequence() : _words(3, 0)
+{
+}
+
+PackedSequence::PackedSequence(const GeneSequence &geneSequence)
+{
+  pack(geneSequence);
+}
+
+void PackedSequence::pack(const GeneSequence &geneSequence)
+{
+  _size = geneSequence.size();
+  _words.assign(_size / NUCLEOTIDES_PER_WORD + 3, 0);
+  _lowerCase.clear();
+  _runs.clear();
+  _characters.clear();
+
+  const unsigned char *sequence = reinterpret_cast<const unsigned char *>(geneSequence.data());
+
+  for (size_t i = 0; i < _size; ++i) {
+    const uint8_t code = codeTable.code[sequence[i]];
+
+    if (code == NONE) {
+      addRun(i, static_cast<char>(sequence[i]));
+      continue;
+    }
+
+    _words[i / NUCLEOTIDES_PER_WORD] |= uint64_t(code & 3) << ((i % NUCLEOTIDES_PER_WORD) * 2);
+    if (code & LOWER_CASE) {
+      if (!_lowerCase.empty() && _lowerCase.back().position + _lowerCase.back().length == i)
+        ++_lowerCase.back().length;
+      else
+        _lowerCase.push_back(Range { i, 1 });
+    }
+  }
+}
+
+void PackedSequence::addRun(size_t position, char nucleotide)
+{
+  if (_runs.empty() || _runs.back().position + _runs.back().length != position) {
+    _runs.push_back(Run { position, 1, 0, nucleotide });
+    return;
+  }
+
+  // A run of the same character becomes a run of characters when another character follows it.
+  Run &run = _runs.back();
+  if (run.nucleotide != nucleotide && run.nucleotide != '\0') {
+    run.offset = _characters.size();
+    _characters.append(run.length, run.nucleotide);
+    run.nucleotide = '\0';
+  }
+
+  if (run.nucleotide == '\0')
+    _characters += nucleotide;
+  ++run.length;
+}
+
+size_t PackedSequence::size() const
+{
+  return _size;
+}
+
+void PackedSequence::unpack(size_t position, size_t length, char *buffer) const
+{
+  for (size_t i = 0; i < length; ++i) {
+    const size_t idx = position + i;
+    buffer[i] = nucleotides[(_words[idx / NUCLEOTIDES_PER_WORD] >> ((idx % NUCLEOTIDES_PER_WORD) * 2)) & 3];
+  }
+
+  // Restore the lower case ranges and the runs overlapping the piece.
+  for (auto range = first(_lowerCase, position); range != _lowerCase.end() && range->position < position + length;
+    ++range) {
+    const size_t begin = std::max(range->position, position);
+    const size_t end   = std::min(range->position + range->length, position + length);
+
+    for (size_t idx = begin; idx < end; ++idx)
+      buffer[idx - position] = lowerCaseNucleotides[(_words[idx / NUCLEOTIDES_PER_WORD] >>
+        ((idx % NUCLEOTIDES_PER_WORD) * 2)) & 3];
+  }
+
+  for (auto run = first(_runs, position); run != _runs.end() && run->position < position + length; ++run) {
+    const size_t begin = std::max(run->position, position);
+    const size_t end   = std::min(run->position + run->length, position + length);
+
+    if (begin >= end)
+      continue;
+
+    if (run->nucleotide != '\0')
+      std::fill(buffer + (begin - position), buffer + (end - position), run->nucleotide);
+    else
+      std::copy(_characters.begin() + (run->offset + begin - run->position),
+        _characters.begin() + (run->offset + end - run->position), buffer + (begin - position));
+  }
+}
+
+PackedGeneSource::PackedGeneSource(const PackedSequence &packedSequence, size_t chunkSize) :
+  _packedSequence(packedSequence), _chunkSize(chunkSize)
+{
+}
+
+void PackedGeneSource::read(const std::function<void(const GeneSequence &)> &consumer) const
+{
+  std::string buffer(std::min(_chunkSize, _packedSequence.size()), '\0');
+
+  for (size_t position = 0; position < _packedSequence.size(); position += _chunkSize) {
+    const size_t length = std::min(_chunkSize, _packedSequence.size() - position);
+
+    _packedSequence.unpack(position, length, &buffer[0]);
+    consumer(GeneSequence(buffer.data(), length));
+  }
+}
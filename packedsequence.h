@@ -0,0 +1,172 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef PACKEDSEQUENCE_H
+#define PACKEDSEQUENCE_H
+
+#include <cstdint>
+#include <vector>
+#include <string>
+
+#include "genesource.h"
+
+/**
+ * A gene sequence packed with 2 bits per nucleotide (A = 0, C = 1, G = 2, T = 3), so a 64 bits word holds 32
+ * nucleotides. The lower case acgt nucleotides are packed with their codes, and only the ranges in lower case are
+ * stored apart. Anything else (N, other ambiguity codes) is stored apart, as runs of consecutive characters, and it is
+ * packed as an A in the words.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class PackedSequence final
+{
+  public:
+    /**
+     * Number of nucleotides stored in each word.
+     *
+     */
+    static const size_t NUCLEOTIDES_PER_WORD = 32;
+
+    /**
+     * Constructor of an empty sequence.
+     *
+     */
+    PackedSequence();
+
+    /**
+     * Constructor.
+     *
+     * @param geneSequence The sequence to be packed.
+     *
+     */
+    PackedSequence(const GeneSequence &geneSequence);
+
+    /**
+     * Pack another sequence, replacing the current one. The memory of the current sequence is reused.
+     *
+     * @param geneSequence The sequence to be packed.
+     *
+     */
+    void pack(const GeneSequence &geneSequence);
+
+    /**
+     * Returns the number of nucleotides in the sequence.
+     *
+     * @return Number of nucleotides in the sequence.
+     *
+     */
+    size_t size() const;
+
+    /**
+     * Returns the packed codes of the 32 nucleotides starting at a position. The nucleotide at the position is in
+     * the lowest 2 bits, and positions after the end of the sequence are returned as 0.
+     *
+     * @param position Position of the first nucleotide.
+     *
+     * @return The packed nucleotides.
+     *
+     */
+    uint64_t window(size_t position) const
+    {
+      const size_t idx   = position / NUCLEOTIDES_PER_WORD;
+      const size_t shift = (position % NUCLEOTIDES_PER_WORD) * 2;
+
+      if (shift == 0)
+        return _words[idx];
+
+      return (_words[idx] >> shift) | (_words[idx + 1] << (64 - shift));
+    }
+
+    /**
+     * Unpack a piece of the sequence, restoring the original characters.
+     *
+     * @param position Position of the first nucleotide.
+     * @param length Number of nucleotides to be unpacked.
+     * @param buffer Buffer that will receive the nucleotides.
+     *
+     */
+    void unpack(size_t position, size_t length, char *buffer) const;
+
+  private:
+    /**
+     * A range of nucleotides in lower case.
+     *
+     */
+    struct Range
+    {
+      size_t position;
+      size_t length;
+    };
+
+    /**
+     * A run of consecutive characters that are not nucleotides. A run of the same character keeps only the character,
+     * the others keep where their characters begin in the characters buffer.
+     *
+     */
+    struct Run
+    {
+      size_t position;
+      size_t length;
+      size_t offset;
+      char   nucleotide;
+    };
+
+    size_t                _size = 0;
+    std::vector<uint64_t> _words;
+    std::vector<Range>    _lowerCase;
+    std::vector<Run>      _runs;
+    std::string           _characters;
+
+    /**
+     * Helper to add a character that is not a nucleotide, extending the last run when it ends at the position.
+     *
+     */
+    void addRun(size_t position, char nucleotide);
+};
+
+/**
+ * A gene source that unpacks a packed sequence lazily, in chunks of a fixed size.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class PackedGeneSource final : public GeneSource
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param packedSequence The packed sequence. It must outlive this object.
+     * @param chunkSize Number of nucleotides delivered per chunk.
+     *
+     */
+    PackedGeneSource(const PackedSequence &packedSequence, size_t chunkSize = 1 << 16);
+
+    /**
+     * Deliver the whole sequence in chunks of at most chunkSize nucleotides.
+     *
+     * @param consumer Function that will receive each chunk of the sequence.
+     *
+     */
+    void read(const std::function<void(const GeneSequence &)> &consumer) const;
+
+  private:
+    const PackedSequence &_packedSequence;
+    size_t                _chunkSize;
+};
+
+#endif
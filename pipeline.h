@@ -0,0 +1,236 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <vector>
+#include <utility>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * A first in, first out queue shared by threads. Producers are blocked while the queue is full, and consumers are
+ * blocked while it is empty, so the memory used by the items in the queue is bounded.
+ *
+ * The items are kept in a ring of slots, and they are swapped in and out of the slots instead of moved: a producer
+ * gets back the item a consumer left in the slot, so the memory held by the items is reused instead of freed and
+ * allocated again for each item.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+template <typename T>
+class BoundedQueue final
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param capacity Maximum number of items in the queue.
+     *
+     */
+    BoundedQueue(size_t capacity) : _items(capacity > 0 ? capacity : 1)
+    {
+    }
+
+    /**
+     * Add an item to the queue, waiting while it is full.
+     *
+     * @param value Item to be swapped into the queue. It receives an item given back by a consumer, to be reused.
+     *
+     * @return True if the item was added, false if the queue was closed.
+     *
+     */
+    bool push(T &value)
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _notFull.wait(lock, [this] { return _closed || _size < _items.size(); });
+      if (_closed)
+        return false;
+
+      using std::swap;
+      swap(_items[(_first + _size) % _items.size()], value);
+      ++_size;
+      _notEmpty.notify_one();
+      return true;
+    }
+
+    /**
+     * Remove an item from the queue, waiting while it is empty.
+     *
+     * @param value Will receive the item. Its previous content is given back to the producers, to be reused.
+     *
+     * @return True if an item was removed, false if the queue was closed and there are no items left.
+     *
+     */
+    bool pop(T &value)
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _notEmpty.wait(lock, [this] { return _closed || _size > 0; });
+      if (_size == 0)
+        return false;
+
+      using std::swap;
+      swap(_items[_first], value);
+      _first = (_first + 1) % _items.size();
+      --_size;
+      _notFull.notify_one();
+      return true;
+    }
+
+    /**
+     * Close the queue. No items can be added anymore, and the consumers are released once the queue is empty.
+     *
+     */
+    void close()
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _closed = true;
+      _notFull.notify_all();
+      _notEmpty.notify_all();
+    }
+
+  private:
+    std::vector<T>          _items;
+    size_t                  _first  = 0;
+    size_t                  _size   = 0;
+    bool                    _closed = false;
+    std::mutex              _mutex;
+    std::condition_variable _notFull;
+    std::condition_variable _notEmpty;
+};
+
+/**
+ * Put back in order items that are processed out of order by several threads. Each item must get a ticket before
+ * being processed, and the number of tickets in use is bounded, so a slow item cannot make the others pile up.
+ *
+ * As the tickets in use are bounded, each one has its own slot in a ring, and the items are swapped in and out of the
+ * slots, like in the BoundedQueue, so their memory is reused.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+template <typename T>
+class ReorderBuffer final
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param capacity Maximum number of tickets in use at the same time.
+     *
+     */
+    ReorderBuffer(size_t capacity) : _items(capacity > 0 ? capacity : 1), _ready(_items.size(), false)
+    {
+    }
+
+    /**
+     * Get the ticket for the next item, waiting while all the tickets are in use.
+     *
+     * @param ticket Will receive the ticket, that gives the position of the item.
+     *
+     * @return True if a ticket was given, false if the buffer was aborted.
+     *
+     */
+    bool reserve(size_t &ticket)
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _changed.wait(lock, [this] { return _aborted || _reserved - _next < _items.size(); });
+      if (_aborted)
+        return false;
+
+      ticket = _reserved++;
+      return true;
+    }
+
+    /**
+     * Store a processed item.
+     *
+     * @param ticket Ticket of the item.
+     * @param value Item to be swapped into the buffer. It receives an item given back by the consumer, to be reused.
+     *
+     */
+    void put(size_t ticket, T &value)
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      const size_t slot = ticket % _items.size();
+
+      using std::swap;
+      swap(_items[slot], value);
+      _ready[slot] = true;
+      _changed.notify_all();
+    }
+
+    /**
+     * Tell that no more tickets will be taken.
+     *
+     */
+    void finish()
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _finished = true;
+      _changed.notify_all();
+    }
+
+    /**
+     * Stop the buffer, releasing everyone that is waiting.
+     *
+     */
+    void abort()
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _aborted = true;
+      _changed.notify_all();
+    }
+
+    /**
+     * Remove the next item in order, waiting until it is processed. Its ticket is given back.
+     *
+     * @param value Will receive the item. Its previous content is given back to the producers, to be reused.
+     *
+     * @return True if an item was removed, false if there are no more items or the buffer was aborted.
+     *
+     */
+    bool next(T &value)
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      const size_t slot = _next % _items.size();
+      _changed.wait(lock, [this, slot] { return _aborted || _ready[slot] || (_finished && _next == _reserved); });
+
+      if (_aborted || !_ready[slot])
+        return false;
+
+      using std::swap;
+      swap(_items[slot], value);
+      _ready[slot] = false;
+      ++_next;
+      _changed.notify_all();
+      return true;
+    }
+
+  private:
+    std::vector<T>          _items;
+    std::vector<bool>       _ready;
+    size_t                  _reserved = 0;
+    size_t                  _next     = 0;
+    bool                    _finished = false;
+    bool                    _aborted  = false;
+    std::mutex              _mutex;
+    std::condition_variable _changed;
+};
+
+#endif
@@ -0,0 +1,234 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "planner.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "shiftand.h"
+#include "simdfilter.h"
+#include "seedfilter.h"
+#include "skipmatcher.h"
+
+const double Planner::VERIFY_COST = 4;
+const double Planner::WORD_COST   = 4;
+const double Planner::FILTER_COST = 0.25;
+const double Planner::SEED_COST   = 8;
+const double Planner::SKIP_COST   = 6;
+
+/**
+ * Returns the probability of each state to accept a random nucleotide.
+ *
+ */
+static
+std::vector<double> acceptance(const StateMachine &stateMachine)
+{
+  const char nucleotides[] = { 'A', 'C', 'G', 'T' };
+
+  std::vector<double> accepted(stateMachine.size(), 0);
+  for (size_t i = 0; i < stateMachine.size(); ++i) {
+    for (auto nucleotide : nucleotides) {
+      if (stateMachine.state(i).contains(nucleotide))
+        accepted[i] += 0.25;
+    }
+  }
+
+  return accepted;
+}
+
+/**
+ * Returns the probability of a walk starting at a random position to reach each state, and the final state at the
+ * end, spending at most maxMismatch mismatches.
+ *
+ */
+static
+std::vector<double> reach(const StateMachine &stateMachine, size_t maxMismatch)
+{
+  const std::vector<double> accepted = acceptance(stateMachine);
+
+  // alive[j] is the probability of being walking with j mismatches.
+  std::vector<double> alive(maxMismatch + 1, 0);
+  std::vector<double> reached(stateMachine.size() + 1, 0);
+  alive[0]   = 1;
+  reached[0] = 1;
+
+  for (size_t i = 0; i < stateMachine.size(); ++i) {
+    const bool mismatch = stateMachine.state(i).acceptMismatch();
+
+    double total = 0;
+    for (size_t j = maxMismatch + 1; j-- > 0;) {
+      alive[j] *= accepted[i];
+      if (mismatch && j > 0)
+        alive[j] += alive[j - 1] * (1 - accepted[i]);
+      total += alive[j];
+    }
+
+    reached[i + 1] = total;
+  }
+
+  return reached;
+}
+
+Planner::Planner(size_t maxMismatch) : _maxMismatch(maxMismatch)
+{
+}
+
+const char *Planner::name(Engine engine)
+{
+  switch (engine) {
+    case Engine::NAIVE:
+      return "naive";
+    case Engine::BIT_PARALLEL:
+      return "bit-parallel";
+    case Engine::FILTER:
+      return "filter";
+    case Engine::SEEDED:
+      return "seeded";
+    case Engine::SKIP:
+      return "skip";
+  }
+
+  return "";
+}
+
+double Planner::cost(Engine engine, const StateMachine &stateMachine) const
+{
+  const size_t size = stateMachine.size();
+  if (size == 0)
+    return 0;
+
+  // More mismatches than states never change the walk.
+  const size_t              maxMismatch = std::min(_maxMismatch, size);
+  const std::vector<double> reached     = reach(stateMachine, maxMismatch);
+
+  double walk = 0;
+  for (size_t i = 0; i < size; ++i)
+    walk += reached[i];
+
+  switch (engine) {
+    case Engine::NAIVE:
+      return VERIFY_COST * walk;
+
+    case Engine::BIT_PARALLEL:
+      if (!ShiftAnd::supports(stateMachine))
+        return std::numeric_limits<double>::infinity();
+
+      // The state machines share the words, and each match is walked again to find its mismatches.
+      return WORD_COST * (maxMismatch + 1) * size / ShiftAnd::MAX_STATES + VERIFY_COST * reached[size] * size;
+
+    case Engine::FILTER: {
+      // Same number of states checked by the filter, the walk of the candidates goes on after them.
+      const size_t checked = std::min(std::min(size, _maxMismatch + 8), SimdFilter::MAX_STATES);
+
+      double candidateWalk = reached[checked] * checked;
+      for (size_t i = checked; i < size; ++i)
+        candidateWalk += reached[i];
+
+      return FILTER_COST * checked + VERIFY_COST * candidateWalk;
+    }
+
+    case Engine::SEEDED: {
+      // A match must hold one seed without mismatches only if there are more seeds than mismatches.
+      if (!SeedFilter::supports(stateMachine, _maxMismatch))
+        return std::numeric_limits<double>::infinity();
+
+      const std::vector<double> accepted = acceptance(stateMachine);
+
+      size_t numberMismatchStates = 0;
+      double information          = 0;
+      for (size_t i = 0; i < size; ++i) {
+        if (stateMachine.state(i).acceptMismatch())
+          ++numberMismatchStates;
+        information -= std::log2(accepted[i]);
+      }
+
+      const size_t mismatches = std::min(_maxMismatch, numberMismatchStates);
+
+      // The seeds carry about the same information, and are searched exactly by the bit-parallel automaton.
+      const size_t seeds      = mismatches + 1;
+      const double candidates = seeds * std::pow(2, -information / seeds);
+      const size_t searched   = std::min(size, seeds * ShiftAnd::MAX_STATES);
+
+      return WORD_COST * searched / ShiftAnd::MAX_STATES + candidates * (SEED_COST + VERIFY_COST * size);
+    }
+
+    case Engine::SKIP: {
+      if (_maxMismatch > 0) {
+        for (size_t i = 0; i < size; ++i) {
+          if (stateMachine.state(i).acceptMismatch())
+            return std::numeric_limits<double>::infinity();
+        }
+      }
+
+      // A window is read backwards until no state can begin the nucleotides read, about when fewer than one of the
+      // alignments of the nucleotides read inside the checked states is expected to match, but never less than the
+      // nucleotides read at once. The window then jumps past the nucleotides read.
+      const std::vector<double> accepted = acceptance(stateMachine);
+      const size_t              checked  = std::min(size, SkipMatcher::MAX_STATES);
+
+      size_t read = std::min(checked, SkipMatcher::GRAM);
+      for (; read < checked; ++read) {
+        double alignments = 0;
+        for (size_t begin = 0; begin + read <= checked; ++begin) {
+          double matched = 1;
+          for (size_t i = begin; i < begin + read; ++i)
+            matched *= accepted[i];
+          alignments += matched;
+        }
+
+        if (alignments < 1)
+          break;
+      }
+
+      const size_t jump = checked - read + 1;
+      return SKIP_COST * read / jump + VERIFY_COST * reached[checked] * size;
+    }
+  }
+
+  return std::numeric_limits<double>::infinity();
+}
+
+Planner::Plan Planner::plan(const StateMachine &stateMachine) const
+{
+  const StateMachine *stateMachines[] = { &stateMachine };
+  return plan(stateMachines, 1);
+}
+
+Planner::Plan Planner::plan(const StateMachine &stateMachine, const StateMachine &reverse) const
+{
+  const StateMachine *stateMachines[] = { &stateMachine, &reverse };
+  return plan(stateMachines, 2);
+}
+
+Planner::Plan Planner::plan(const StateMachine *const stateMachines[], size_t count) const
+{
+  // On equal costs the engines listed first are kept.
+  const Engine engines[] = { Engine::BIT_PARALLEL, Engine::SKIP, Engine::FILTER, Engine::SEEDED, Engine::NAIVE };
+
+  Plan best { Engine::NAIVE, std::numeric_limits<double>::infinity() };
+  for (auto engine : engines) {
+    double total = 0;
+    for (size_t i = 0; i < count; ++i)
+      total += cost(engine, *stateMachines[i]);
+
+    if (total < best.cost)
+      best = Plan { engine, total };
+  }
+
+  return best;
+}
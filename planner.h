@@ -0,0 +1,146 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include "statemachine.h"
+
+/**
+ * Choose how each state machine is matched against a gene sequence. The states are inspected, how many nucleotides
+ * each one accepts, where mismatches are accepted and how many, to estimate the probability of a walk reaching each
+ * state from a random position. From it the cost of each engine is estimated, in nucleotide comparisons per position
+ * of the gene sequence, and the cheapest engine is chosen.
+ *
+ * The costs are estimates, good enough to compare the engines, not to predict the time of a search.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class Planner final
+{
+  public:
+    /**
+     * The engines a state machine can be matched with: walking the state machine at every position (NAIVE), the
+     * bit-parallel automaton (BIT_PARALLEL), the vectorized filter of the first states (FILTER), the exact search of
+     * the seeds (SEEDED) or the skip search of the first states, when there can be no mismatches (SKIP). The positions
+     * found by the last four are verified by walking the state machine.
+     *
+     */
+    enum class Engine { NAIVE, BIT_PARALLEL, FILTER, SEEDED, SKIP };
+
+    /**
+     * The engine chosen for a state machine, or for both strands of a pattern, and its estimated cost per position.
+     *
+     */
+    struct Plan
+    {
+      Engine engine;
+      double cost;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param maxMismatch Maximum supported mismatches per state machine.
+     *
+     */
+    Planner(size_t maxMismatch);
+
+    /**
+     * Returns the name of an engine.
+     *
+     * @param engine The engine.
+     *
+     * @return The engine name.
+     *
+     */
+    static const char *name(Engine engine);
+
+    /**
+     * Estimate the cost of matching a state machine with an engine.
+     *
+     * @param engine The engine.
+     * @param stateMachine The state machine to be matched.
+     *
+     * @return The estimated cost per position of the gene sequence, or infinity if the engine cannot match the state
+     *         machine.
+     *
+     */
+    double cost(Engine engine, const StateMachine &stateMachine) const;
+
+    /**
+     * Choose the cheapest engine for a state machine.
+     *
+     * @param stateMachine The state machine to be matched.
+     *
+     * @return The chosen plan.
+     *
+     */
+    Plan plan(const StateMachine &stateMachine) const;
+
+    /**
+     * Choose the cheapest engine for both strands of a pattern, matched in the same pass.
+     *
+     * @param stateMachine The state machine of the '+' strand.
+     * @param reverse The state machine of the '-' strand.
+     *
+     * @return The chosen plan.
+     *
+     */
+    Plan plan(const StateMachine &stateMachine, const StateMachine &reverse) const;
+
+  private:
+    /**
+     * Cost of walking a state machine one state.
+     *
+     */
+    static const double VERIFY_COST;
+
+    /**
+     * Cost of a level of a 64 states word of the bit-parallel automaton.
+     *
+     */
+    static const double WORD_COST;
+
+    /**
+     * Cost of a state checked by the vectorized filter.
+     *
+     */
+    static const double FILTER_COST;
+
+    /**
+     * Cost of collecting a candidate found by a seed.
+     *
+     */
+    static const double SEED_COST;
+
+    /**
+     * Cost of a nucleotide read by the skip search.
+     *
+     */
+    static const double SKIP_COST;
+
+    size_t _maxMismatch;
+
+    /**
+     * Helper to choose the cheapest engine for some state machines matched in the same pass.
+     *
+     */
+    Plan plan(const StateMachine *const stateMachines[], size_t count) const;
+};
+
+#endif
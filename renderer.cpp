@@ -0,0 +1,188 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "renderer.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+Renderer::Renderer(const HitStore &store) : _store(store), _states(store.stateMachines())
+{
+}
+
+const std::vector<StateMachine> &Renderer::stateMachines() const
+{
+  return _states;
+}
+
+void Renderer::setLabels(const std::vector<std::string> &labels)
+{
+  _labels = labels;
+}
+
+void Renderer::setMaxMismatch(size_t maxMismatch)
+{
+  _maxMismatch = maxMismatch;
+}
+
+void Renderer::setRegions(const std::vector<std::string> &regions)
+{
+  _regions.clear();
+  for (auto &text : regions) {
+    Region region;
+    region.text   = text;
+    region.begin  = 1;
+    region.end    = static_cast<size_t>(-1);
+    region.ranged = false;
+
+    // A text that is not a valid region can still be the name of a record holding a ':'.
+    const size_t colon = text.rfind(':');
+    if (colon != std::string::npos && FastaIndex::parseRange(text.substr(colon + 1), region.begin, region.end)) {
+      region.name   = text.substr(0, colon);
+      region.ranged = true;
+    }
+
+    _regions.push_back(region);
+  }
+}
+
+void Renderer::render(Sink &sink, const std::string &geneFile, const FmIndex *index) const
+{
+  FastaReader                             reader;
+  FastaIndex                              fastaIndex;
+  std::unordered_map<std::string, size_t> indexRecords;
+  if (sink.needsMarks()) {
+    if (index) {
+      for (size_t record = 0; record < index->records(); ++record)
+        indexRecords.emplace(index->name(record).substr(1), record);
+    }
+    else {
+      if (!reader.open(geneFile))
+        throw HitStoreException("Problems to open the input file: " + geneFile);
+
+      if (!fastaIndex.loadOrBuild(geneFile, reader))
+        throw HitStoreException("Cannot index the input file, its lines have different lengths: " + geneFile);
+    }
+  }
+
+  sink.createHeader(_store.commandLine());
+
+  std::vector<HIT>            hit, patternHit;
+  std::vector<PositionToMark> marks;
+  std::vector<char>           buffer;
+  size_t counter = 0;
+  size_t idx     = 0;
+  for (size_t record = 0; record < _store.records(); ++record) {
+    const std::string name = _store.name(record);
+    const std::string id   = FastaIndex::sequenceId(name);
+
+    // The hits of a state machine are consecutive, so its minimum is checked once all of them are filtered.
+    hit.clear();
+    patternHit.clear();
+    for (; idx < _store.hits() && _store.recordId(idx) == record; ++idx) {
+      if (keep(id, idx))
+        patternHit.push_back(HIT(_store.begin(idx), _store.end(idx), _store.numberMismatches(idx),
+          _store.patternId(idx)));
+
+      const bool last = idx + 1 == _store.hits() || _store.recordId(idx + 1) != record ||
+        _store.patternId(idx + 1) != _store.patternId(idx);
+      if (last) {
+        if (!patternHit.empty() && _states.at(_store.patternId(idx)).checkNumberOfPatterns(patternHit))
+          hit.insert(hit.end(), patternHit.begin(), patternHit.end());
+        patternHit.clear();
+      }
+    }
+
+    if (hit.empty())
+      continue;
+
+    GeneSequence geneSequence;
+    marks.clear();
+    if (sink.needsMarks()) {
+      if (index) {
+        auto found = indexRecords.find(name);
+        if (found == indexRecords.end())
+          throw HitStoreException("Record not found in the index: " + name);
+
+        geneSequence = index->sequence(found->second);
+      }
+      else {
+        FastaIndex::Region region;
+        GeneSequence rawSequence;
+        if (!fastaIndex.find(id, region) || !reader.slice(region.first, region.last, rawSequence))
+          throw HitStoreException("Record not found in the input file: " + name);
+
+        size_t rawOffset = 0;
+        buffer.resize(region.length);
+        geneSequence = GeneSequence(buffer.data(),
+          FastaReader::copyNucleotides(rawSequence, rawOffset, buffer.data(), region.length));
+      }
+
+      mark(geneSequence, hit, marks);
+    }
+
+    sink.appendGene(name, name, 0, BufferedGeneSource(geneSequence), marks, hit);
+    ++counter;
+  }
+
+  sink.createFooter(counter);
+}
+
+bool Renderer::keep(const std::string &id, size_t hit) const
+{
+  if (_store.numberMismatches(hit) > _maxMismatch)
+    return false;
+
+  if (!_labels.empty() &&
+    std::find(_labels.begin(), _labels.end(), _states.at(_store.patternId(hit)).label()) == _labels.end())
+    return false;
+
+  if (_regions.empty())
+    return true;
+
+  for (auto &region : _regions) {
+    if (region.text == id)
+      return true;
+
+    if (region.ranged && region.name == id && _store.begin(hit) + 1 >= region.begin &&
+      _store.end(hit) + 1 <= region.end)
+      return true;
+  }
+
+  return false;
+}
+
+void Renderer::mark(const GeneSequence &geneSequence, const std::vector<HIT> &hit,
+  std::vector<PositionToMark> &marks) const
+{
+  for (auto &h : hit) {
+    const size_t sm = h.patternId();
+    marks.push_back(PositionToMark(PositionToMark::Type::BEGIN, h.begin(), sm));
+    marks.push_back(PositionToMark(PositionToMark::Type::END, h.end(), sm));
+
+    // The mismatches are the states that did not contain the nucleotide when the hit was verified.
+    StateCursor cursor(_states.at(sm));
+    for (size_t idx = h.begin(); idx <= h.end() && idx < geneSequence.size(); ++idx) {
+      const State *state = cursor.nextState();
+      if (!state->contains(geneSequence[idx]) && state->acceptMismatch())
+        marks.push_back(PositionToMark(PositionToMark::Type::MISMATCH, idx, sm));
+    }
+  }
+
+  // The hits are grouped by state machine, so a stable sort keeps the equal marks in the state machine order, as
+  // they are given by the search.
+  std::stable_sort(marks.begin(), marks.end(), PositionToMark::before);
+}
@@ -0,0 +1,121 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include "hitstore.h"
+#include "fastaindex.h"
+#include "fmindex.h"
+
+/**
+ * This class will write the hits of a hit store to a sink, filtered by label, number of mismatches or region. The
+ * gene sequences are only read when the sink writes them: each record with hits is read directly from its position
+ * in the FASTA file or in the index, and its marks are rebuilt walking the state machines at the hits.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class Renderer final
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param store Hit store to be written. It must outlive this object.
+     *
+     */
+    Renderer(const HitStore &store);
+
+    /**
+     * Returns the pattern table of the hit store.
+     *
+     * @return The state machines used in the search.
+     *
+     */
+    const std::vector<StateMachine> &stateMachines() const;
+
+    /**
+     * Keep only the hits of some state machines.
+     *
+     * @param labels Labels of the state machines to be kept, or empty to keep all of them (default).
+     *
+     */
+    void setLabels(const std::vector<std::string> &labels);
+
+    /**
+     * Keep only the hits with up to a number of mismatches.
+     *
+     * @param maxMismatch Maximum number of mismatches (default: all the hits are kept).
+     *
+     */
+    void setMaxMismatch(size_t maxMismatch);
+
+    /**
+     * Keep only the hits inside some records or regions of the records.
+     *
+     * @param regions Regions given as "name", "name:begin" or "name:begin-end", with 1-based inclusive positions, or
+     *                empty to keep all the records (default).
+     *
+     */
+    void setRegions(const std::vector<std::string> &regions);
+
+    /**
+     * Write the hits to a sink. The state machines with less hits than their minimum after the filters are dropped.
+     * A HitStoreException is fired if the sink writes the sequences and a record cannot be read.
+     *
+     * @param sink Sink receiving the hits.
+     * @param geneFile Gene Fasta file searched, or empty when an index is given.
+     * @param index Index searched, or nullptr when a gene Fasta file is given. Only needed when the sink writes the
+     *              sequences.
+     *
+     */
+    void render(Sink &sink, const std::string &geneFile, const FmIndex *index) const;
+
+  private:
+    /**
+     * A region to be kept: a whole record named as the text, or the positions of the named record.
+     *
+     */
+    struct Region
+    {
+      std::string text;
+      std::string name;
+      size_t      begin;
+      size_t      end;
+      bool        ranged;
+    };
+
+    const HitStore            &_store;
+    std::vector<StateMachine>  _states;
+    std::vector<std::string>   _labels;
+    std::vector<Region>        _regions;
+    size_t                     _maxMismatch = static_cast<size_t>(-1);
+
+    /**
+     * Helper to tell if a hit passes the filters.
+     *
+     */
+    bool keep(const std::string &id, size_t hit) const;
+
+    /**
+     * Helper to find the marks of the hits of a record: their beginning, ending and mismatches.
+     *
+     */
+    void mark(const GeneSequence &geneSequence, const std::vector<HIT> &hit, std::vector<PositionToMark> &marks) const;
+};
+
+#endif
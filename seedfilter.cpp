@@ -0,0 +1,112 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "seedfilter.h"
+
+#include <cmath>
+#include <algorithm>
+
+SeedFilter::SeedFilter(size_t maxMismatch) : _maxMismatch(maxMismatch), _seeds(0)
+{
+}
+
+bool SeedFilter::supports(const StateMachine &stateMachine, size_t maxMismatch)
+{
+  size_t numberMismatchStates = 0;
+  for (size_t i = 0; i < stateMachine.size(); ++i) {
+    if (stateMachine.state(i).acceptMismatch())
+      ++numberMismatchStates;
+  }
+
+  return std::min(maxMismatch, numberMismatchStates) < stateMachine.size();
+}
+
+void SeedFilter::add(const StateMachine &stateMachine, size_t patternId)
+{
+  const size_t size = stateMachine.size();
+
+  // The information of each state is how much it narrows the nucleotides, so N states are worth nothing.
+  const char nucleotides[] = { 'A', 'C', 'G', 'T' };
+
+  std::vector<double> information(size + 1, 0);
+  size_t numberMismatchStates = 0;
+  for (size_t i = 0; i < size; ++i) {
+    const State &state = stateMachine.state(i);
+
+    size_t classSize = 0;
+    for (auto nucleotide : nucleotides) {
+      if (state.contains(nucleotide))
+        ++classSize;
+    }
+
+    information[i + 1] = information[i] + 2 - std::log2(static_cast<double>(classSize));
+    if (state.acceptMismatch())
+      ++numberMismatchStates;
+  }
+
+  // Cut the state machine in seeds carrying about the same information.
+  const size_t seeds = std::min(_maxMismatch, numberMismatchStates) + 1;
+  const double total = information[size];
+
+  size_t begin = 0;
+  for (size_t s = 1; s <= seeds; ++s) {
+    size_t end = size;
+    if (s < seeds) {
+      end = begin + 1;
+      if (total > 0) {
+        while (end < size - (seeds - s) && information[end] < total * s / seeds)
+          ++end;
+      }
+      else
+        end = std::max(end, size * s / seeds);
+    }
+
+    // Only the beginning of the seeds too long for the bit-parallel matcher is searched.
+    const size_t length = std::min(end - begin, ShiftAnd::MAX_STATES);
+
+    _seeds.add(stateMachine.slice(begin, length), _seedInfo.size());
+    _seedInfo.push_back(Seed { patternId, size, begin });
+    begin = end;
+  }
+}
+
+void SeedFilter::search(const GeneSequence &geneSequence, std::vector<std::vector<size_t>> &candidates,
+  std::vector<std::vector<size_t>> &begins, std::vector<uint64_t> &states) const
+{
+  if (_seedInfo.empty())
+    return;
+
+  begins.resize(_seedInfo.size());
+  for (auto &seedBegins : begins)
+    seedBegins.clear();
+  _seeds.search(geneSequence, begins, states);
+
+  // The seeds of a pattern are added together, so its candidates are complete after its last seed.
+  for (size_t s = 0; s < _seedInfo.size(); ++s) {
+    const Seed &seed = _seedInfo[s];
+    std::vector<size_t> &patternCandidates = candidates.at(seed.patternId);
+
+    for (auto begin : begins[s]) {
+      if (begin >= seed.offset && begin - seed.offset + seed.patternSize <= geneSequence.size())
+        patternCandidates.push_back(begin - seed.offset);
+    }
+
+    if (s + 1 == _seedInfo.size() || _seedInfo[s + 1].patternId != seed.patternId) {
+      std::sort(patternCandidates.begin(), patternCandidates.end());
+      patternCandidates.erase(std::unique(patternCandidates.begin(), patternCandidates.end()), patternCandidates.end());
+    }
+  }
+}
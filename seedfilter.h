@@ -0,0 +1,92 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef SEEDFILTER_H
+#define SEEDFILTER_H
+
+#include "shiftand.h"
+
+/**
+ * Pigeonhole filter for searches with mismatches. A state machine accepting up to k mismatches is split in k + 1
+ * seeds, and any match must contain at least one of them without mismatches. All the seeds are searched exactly, in
+ * a single pass, and only the positions around the seeds found are candidates to be verified.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class SeedFilter final
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param maxMismatch Maximum supported mismatches per state machine.
+     *
+     */
+    SeedFilter(size_t maxMismatch);
+
+    /**
+     * Returns if a state machine can be split in more seeds than the mismatches it can have, so any match holds one
+     * seed without mismatches.
+     *
+     * @param stateMachine The state machine to be checked.
+     * @param maxMismatch Maximum supported mismatches.
+     *
+     * @return True if the state machine can be added to the filter, otherwise false.
+     *
+     */
+    static bool supports(const StateMachine &stateMachine, size_t maxMismatch);
+
+    /**
+     * Split a state machine in seeds and add them to the filter.
+     *
+     * @param stateMachine The state machine to be added. It must be supported by the filter.
+     * @param patternId Id reported together with the candidates of this state machine.
+     *
+     */
+    void add(const StateMachine &stateMachine, size_t patternId);
+
+    /**
+     * Find the candidate positions where the state machines may be beginning.
+     *
+     * @param geneSequence Sequence of nucleotides to be scanned.
+     * @param candidates Vector indexed by pattern id that will receive the candidates, in ascending order and without
+     *                   repetitions. It must be large enough to hold all the pattern ids added to the filter.
+     * @param begins Buffer for the seeds found, reused between searches.
+     * @param states Buffer for the automaton states, reused between searches.
+     *
+     */
+    void search(const GeneSequence &geneSequence, std::vector<std::vector<size_t>> &candidates,
+      std::vector<std::vector<size_t>> &begins, std::vector<uint64_t> &states) const;
+
+  private:
+    /**
+     * Where a seed is inside its state machine.
+     *
+     */
+    struct Seed
+    {
+      size_t patternId;
+      size_t patternSize;
+      size_t offset;
+    };
+
+    size_t            _maxMismatch;
+    ShiftAnd          _seeds;
+    std::vector<Seed> _seedInfo;
+};
+
+#endif
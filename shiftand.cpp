@@ -0,0 +1,113 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "shiftand.h"
+
+#include <algorithm>
+
+const size_t ShiftAnd::MAX_STATES;
+
+ShiftAnd::ShiftAnd(size_t maxMismatch) : _maxMismatch(maxMismatch)
+{
+}
+
+bool ShiftAnd::supports(const StateMachine &stateMachine)
+{
+  return stateMachine.size() > 0 && stateMachine.size() <= MAX_STATES;
+}
+
+void ShiftAnd::add(const StateMachine &stateMachine, size_t patternId)
+{
+  if (!supports(stateMachine))
+    throw ParseException("Pattern too long for the bit-parallel matcher: " + stateMachine.pattern());
+
+  const size_t size = stateMachine.size();
+
+  auto word = std::find_if(_words.begin(), _words.end(), [size] (const Word &w) -> bool {
+    return w.used + size <= MAX_STATES;
+  });
+
+  if (word == _words.end()) {
+    _words.push_back(Word());
+    word = _words.end() - 1;
+    std::fill(word->masks, word->masks + 256, 0);
+  }
+
+  size_t numberMismatchStates = 0;
+  for (size_t i = 0; i < size; ++i) {
+    const State &state = stateMachine.state(i);
+    const uint64_t bit = uint64_t(1) << (word->used + i);
+
+    for (size_t c = 0; c < 256; ++c) {
+      if (state.contains(static_cast<char>(c)))
+        word->masks[c] |= bit;
+    }
+
+    if (state.acceptMismatch()) {
+      word->mismatchMask |= bit;
+      ++numberMismatchStates;
+    }
+  }
+
+  const size_t finalBit = word->used + size - 1;
+
+  word->startMask |= uint64_t(1) << word->used;
+  word->finalMask |= uint64_t(1) << finalBit;
+  word->patternId[finalBit]   = patternId;
+  word->patternSize[finalBit] = size;
+  word->maxMismatch = std::max(word->maxMismatch, std::min(_maxMismatch, numberMismatchStates));
+  word->used += size;
+}
+
+bool ShiftAnd::empty() const
+{
+  return _words.empty();
+}
+
+void ShiftAnd::search(const GeneSequence &geneSequence, std::vector<std::vector<size_t>> &begins,
+  std::vector<uint64_t> &states) const
+{
+  const size_t length = geneSequence.size();
+  const unsigned char *sequence = reinterpret_cast<const unsigned char *>(geneSequence.data());
+
+  // For every word, r[j] holds the states reached with at most j mismatches.
+  const size_t levels = _maxMismatch < MAX_STATES ? _maxMismatch + 1 : MAX_STATES + 1;
+  states.assign(_words.size() * levels, 0);
+
+  for (size_t idx = 0; idx < length; ++idx) {
+    uint64_t *r = states.data();
+    for (auto &word : _words) {
+      const uint64_t mask = word.masks[sequence[idx]];
+
+      uint64_t previous = r[0];
+      r[0] = ((r[0] << 1) | word.startMask) & mask;
+      for (size_t j = 1; j <= word.maxMismatch; ++j) {
+        const uint64_t current = r[j];
+        r[j] = (((current << 1) | word.startMask) & mask) | (((previous << 1) | word.startMask) & word.mismatchMask);
+        previous = current;
+      }
+
+      uint64_t found = r[word.maxMismatch] & word.finalMask;
+      while (found) {
+        const size_t bit = __builtin_ctzll(found);
+        begins[word.patternId[bit]].push_back(idx + 1 - word.patternSize[bit]);
+        found &= found - 1;
+      }
+
+      r += levels;
+    }
+  }
+}
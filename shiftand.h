@@ -0,0 +1,113 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef SHIFTAND_H
+#define SHIFTAND_H
+
+#include <cstdint>
+
+#include "statemachine.h"
+#include "genesequence.h"
+
+/**
+ * Bit-parallel (Shift-And / Wu-Manber) automaton for a set of state machines. Each state is mapped to one bit of a
+ * 64 bits word and every nucleotide gets a mask with the bits of the states that contain it, so the state machines
+ * are advanced with a couple of shifts and ands per nucleotide. Several state machines are packed side by side in
+ * the same word, so all of them are matched in a single traversal of the gene sequence. Mismatches are handled
+ * keeping one word per accepted mismatch, where only the states that accept mismatches can be used to move to the
+ * next level.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class ShiftAnd final
+{
+  public:
+    /**
+     * Maximum number of states supported by the bit-parallel representation.
+     *
+     */
+    static const size_t MAX_STATES = 64;
+
+    /**
+     * Constructor.
+     *
+     * @param maxMismatch Maximum supported mismatches per state machine.
+     *
+     */
+    ShiftAnd(size_t maxMismatch);
+
+    /**
+     * Returns if a state machine can be compiled to the bit-parallel representation.
+     *
+     * @param stateMachine The state machine to be checked.
+     *
+     * @return True if the state machine can be compiled, otherwise false.
+     *
+     */
+    static bool supports(const StateMachine &stateMachine);
+
+    /**
+     * Compile a new state machine into the automaton.
+     *
+     * @param stateMachine The state machine to be compiled. It must be supported by the bit-parallel representation.
+     * @param patternId Id reported together with the matches of this state machine.
+     *
+     */
+    void add(const StateMachine &stateMachine, size_t patternId);
+
+    /**
+     * Returns if there is no state machine compiled into the automaton.
+     *
+     * @return True if the automaton is empty, otherwise false.
+     *
+     */
+    bool empty() const;
+
+    /**
+     * Scan a gene sequence in one pass and store the position where each match is beginning.
+     *
+     * @param geneSequence Sequence of nucleotides to be scanned.
+     * @param begins Vector indexed by pattern id that will receive the beginning of each match, in ascending order.
+     *               It must be large enough to hold all the pattern ids added to the automaton.
+     * @param states Buffer for the automaton states, reused between searches.
+     *
+     */
+    void search(const GeneSequence &geneSequence, std::vector<std::vector<size_t>> &begins,
+      std::vector<uint64_t> &states) const;
+
+  private:
+    /**
+     * A 64 bits lane shared by one or more state machines.
+     *
+     */
+    struct Word
+    {
+      uint64_t masks[256];
+      uint64_t mismatchMask = 0;
+      uint64_t startMask    = 0;
+      uint64_t finalMask    = 0;
+      size_t   used         = 0;
+      size_t   maxMismatch  = 0;
+      size_t   patternId[MAX_STATES];
+      size_t   patternSize[MAX_STATES];
+    };
+
+    size_t            _maxMismatch;
+    std::vector<Word> _words;
+};
+
+#endif
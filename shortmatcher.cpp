@@ -0,0 +1,111 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "shortmatcher.h"
+
+const size_t ShortMatcher::MAX_STATES;
+const size_t ShortMatcher::MANY_MISMATCHES;
+
+bool ShortMatcher::supports(const StateMachine &stateMachine)
+{
+  return stateMachine.size() > 0 && stateMachine.size() <= MAX_STATES;
+}
+
+ShortMatcher::ShortMatcher(const StateMachine &stateMachine, size_t maxMismatch) :
+  _size(stateMachine.size()), _maxMismatch(maxMismatch)
+{
+  // The bits after the last state are always set, so they never mismatch.
+  _padding = static_cast<uint32_t>(~0ULL << _size);
+  _strict  = 0;
+  for (size_t c = 0; c < 256; ++c)
+    _masks[c] = _padding;
+
+  for (size_t i = 0; i < _size; ++i) {
+    const State &state = stateMachine.state(i);
+
+    for (size_t c = 0; c < 256; ++c) {
+      if (state.contains(static_cast<char>(c)))
+        _masks[c] |= 1U << i;
+    }
+
+    if (!state.acceptMismatch())
+      _strict |= 1U << i;
+  }
+
+  if (maxMismatch == 0)
+    _kernel = kernels<0>()[_size];
+  else if (maxMismatch == 1)
+    _kernel = kernels<1>()[_size];
+  else
+    _kernel = kernels<MANY_MISMATCHES>()[_size];
+}
+
+bool ShortMatcher::match(const GeneSequence &geneSequence, size_t idx, uint32_t &mismatches) const
+{
+  if (idx + _size > geneSequence.size())
+    return false;
+
+  return _kernel(*this, reinterpret_cast<const unsigned char *>(geneSequence.data()) + idx,
+    geneSequence.size() - idx, mismatches);
+}
+
+template <size_t MISMATCH>
+const ShortMatcher::Kernel *ShortMatcher::kernels()
+{
+  static const Kernel table[MAX_STATES + 1] = {
+    nullptr,
+    &kernel<4, MISMATCH>,  &kernel<4, MISMATCH>,  &kernel<4, MISMATCH>,  &kernel<4, MISMATCH>,
+    &kernel<8, MISMATCH>,  &kernel<8, MISMATCH>,  &kernel<8, MISMATCH>,  &kernel<8, MISMATCH>,
+    &kernel<16, MISMATCH>, &kernel<16, MISMATCH>, &kernel<16, MISMATCH>, &kernel<16, MISMATCH>,
+    &kernel<16, MISMATCH>, &kernel<16, MISMATCH>, &kernel<16, MISMATCH>, &kernel<16, MISMATCH>,
+    &kernel<32, MISMATCH>, &kernel<32, MISMATCH>, &kernel<32, MISMATCH>, &kernel<32, MISMATCH>,
+    &kernel<32, MISMATCH>, &kernel<32, MISMATCH>, &kernel<32, MISMATCH>, &kernel<32, MISMATCH>,
+    &kernel<32, MISMATCH>, &kernel<32, MISMATCH>, &kernel<32, MISMATCH>, &kernel<32, MISMATCH>,
+    &kernel<32, MISMATCH>, &kernel<32, MISMATCH>, &kernel<32, MISMATCH>, &kernel<32, MISMATCH>
+  };
+
+  return table;
+}
+
+template <size_t STATES, size_t MISMATCH>
+bool ShortMatcher::kernel(const ShortMatcher &matcher, const unsigned char *sequence, size_t length,
+  uint32_t &mismatches)
+{
+  const uint32_t *masks   = matcher._masks;
+  uint32_t        matched = matcher._padding;
+
+  // Near the end of the sequence the bucket would read past it, so only the states are read.
+  if (length >= STATES) {
+    for (size_t i = 0; i < STATES; ++i)
+      matched |= masks[sequence[i]] & (1U << i);
+  }
+  else {
+    for (size_t i = 0; i < matcher._size; ++i)
+      matched |= masks[sequence[i]] & (1U << i);
+  }
+
+  mismatches = ~matched;
+  if (mismatches & matcher._strict)
+    return false;
+
+  if (MISMATCH == 0)
+    return mismatches == 0;
+
+  if (MISMATCH == 1)
+    return (mismatches & (mismatches - 1)) == 0;
+
+  return static_cast<size_t>(__builtin_popcount(mismatches)) <= matcher._maxMismatch;
+}
@@ -0,0 +1,112 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef SHORTMATCHER_H
+#define SHORTMATCHER_H
+
+#include "statemachine.h"
+#include "genesequence.h"
+
+/**
+ * Verifier for the short state machines. Instead of walking the states one by one, the nucleotides of a position are
+ * checked against all states at once: each nucleotide selects the mask of the states containing it, and the masks are
+ * merged in a single word, where the missing bits are the mismatches.
+ *
+ * The checks are done by kernels specialized on the number of states, rounded up to a bucket of 4, 8, 16 or 32 states
+ * so the loop over the states is unrolled, and on the maximum number of mismatches, so only the needed test is done.
+ * The kernel of a state machine is taken from a table indexed by its number of states.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class ShortMatcher final
+{
+  public:
+    /**
+     * Maximum number of states supported by the matcher.
+     *
+     */
+    static const size_t MAX_STATES = 32;
+
+    /**
+     * Returns if a state machine can be compiled to the matcher.
+     *
+     * @param stateMachine The state machine to be checked.
+     *
+     * @return True if the state machine has from 1 to MAX_STATES states, otherwise false.
+     *
+     */
+    static bool supports(const StateMachine &stateMachine);
+
+    /**
+     * Constructor.
+     *
+     * @param stateMachine The state machine to be compiled. It must be supported by the matcher.
+     * @param maxMismatch Maximum supported mismatches.
+     *
+     */
+    ShortMatcher(const StateMachine &stateMachine, size_t maxMismatch);
+
+    /**
+     * Check if the state machine matches starting at a gene sequence position.
+     *
+     * @param geneSequence The sequence to be checked.
+     * @param idx Position where the match begins.
+     * @param mismatches Will receive the mismatched states, the first state in the lowest bit.
+     *
+     * @return True if the state machine matches, otherwise false.
+     *
+     */
+    bool match(const GeneSequence &geneSequence, size_t idx, uint32_t &mismatches) const;
+
+  private:
+    /**
+     * Signature of the kernels: the matcher, the nucleotides from the position being checked, how many of them can
+     * be read, and the mismatches found.
+     *
+     */
+    typedef bool (*Kernel)(const ShortMatcher &, const unsigned char *, size_t, uint32_t &);
+
+    /**
+     * Kernel of the maximum number of mismatches, used from this number of mismatches on.
+     *
+     */
+    static const size_t MANY_MISMATCHES = 2;
+
+    size_t   _size;
+    size_t   _maxMismatch;
+    uint32_t _masks[256];
+    uint32_t _padding;
+    uint32_t _strict;
+    Kernel   _kernel;
+
+    /**
+     * Helper to return the table of the kernels of a maximum number of mismatches, indexed by number of states.
+     *
+     */
+    template <size_t MISMATCH>
+    static const Kernel *kernels();
+
+    /**
+     * Helper to check the states of a bucket, the states after the last one accept any nucleotide.
+     *
+     */
+    template <size_t STATES, size_t MISMATCH>
+    static bool kernel(const ShortMatcher &matcher, const unsigned char *sequence, size_t length,
+      uint32_t &mismatches);
+};
+
+#endif
@@ -0,0 +1,336 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "simdfilter.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HUNT_X86
+#include <immintrin.h>
+#endif
+
+const size_t SimdFilter::MAX_STATES;
+
+SimdFilter::SimdFilter(const StateMachine &stateMachine, size_t maxMismatch) : _strands(1)
+{
+  // Check enough states to reject a position with more mismatches than accepted.
+  _size = std::min(std::min(stateMachine.size(), maxMismatch + 8), MAX_STATES);
+  compile(0, stateMachine, maxMismatch);
+}
+
+SimdFilter::SimdFilter(const StateMachine &stateMachine, const StateMachine &reverse, size_t maxMismatch) :
+  _strands(2)
+{
+  _size = std::min(std::min(stateMachine.size(), maxMismatch + 8), MAX_STATES);
+  compile(0, stateMachine, maxMismatch);
+  compile(1, reverse, maxMismatch);
+}
+
+void SimdFilter::compile(size_t strand, const StateMachine &stateMachine, size_t maxMismatch)
+{
+  const char nucleotides[] = { 'A', 'C', 'G', 'T' };
+
+  size_t numberMismatchStates = 0;
+  for (size_t i = 0; i < _size; ++i) {
+    const State &state = stateMachine.state(i);
+
+    for (size_t c = 0; c < 256; ++c)
+      _table[strand][i][c] = state.contains(static_cast<char>(c));
+
+    _classSize[strand][i] = 0;
+    for (auto nucleotide : nucleotides) {
+      if (state.contains(nucleotide))
+        _classes[strand][i][_classSize[strand][i]++] = nucleotide;
+    }
+
+    _mismatch[strand][i] = state.acceptMismatch();
+    if (_mismatch[strand][i])
+      ++numberMismatchStates;
+  }
+
+  _maxMismatch[strand] = std::min(maxMismatch, numberMismatchStates);
+}
+
+SimdFilter::Kernel SimdFilter::best()
+{
+  if (supported(Kernel::AVX512))
+    return Kernel::AVX512;
+
+  if (supported(Kernel::AVX2))
+    return Kernel::AVX2;
+
+  if (supported(Kernel::SSE42))
+    return Kernel::SSE42;
+
+  return Kernel::SCALAR;
+}
+
+bool SimdFilter::supported(Kernel kernel)
+{
+  switch (kernel) {
+    case Kernel::SCALAR:
+      return true;
+#ifdef HUNT_X86
+    case Kernel::SSE42:
+      return __builtin_cpu_supports("sse4.2");
+    case Kernel::AVX2:
+      return __builtin_cpu_supports("avx2");
+    case Kernel::AVX512:
+      return __builtin_cpu_supports("avx512bw");
+#endif
+    default:
+      return false;
+  }
+}
+
+const char *SimdFilter::name(Kernel kernel)
+{
+  switch (kernel) {
+    case Kernel::SSE42:
+      return "sse4.2";
+    case Kernel::AVX2:
+      return "avx2";
+    case Kernel::AVX512:
+      return "avx512";
+    default:
+      return "scalar";
+  }
+}
+
+bool SimdFilter::parse(const std::string &name, Kernel &kernel)
+{
+  for (auto k : { Kernel::SCALAR, Kernel::SSE42, Kernel::AVX2, Kernel::AVX512 }) {
+    if (name == SimdFilter::name(k)) {
+      kernel = k;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void SimdFilter::search(const GeneSequence &geneSequence, size_t from, size_t to, std::vector<size_t> &candidates,
+  Kernel kernel) const
+{
+  std::vector<size_t> *strandCandidates[] = { &candidates };
+  search(geneSequence, from, to, strandCandidates, 1, kernel);
+}
+
+void SimdFilter::search(const GeneSequence &geneSequence, size_t from, size_t to, std::vector<size_t> &candidates,
+  std::vector<size_t> &reverseCandidates, Kernel kernel) const
+{
+  std::vector<size_t> *strandCandidates[] = { &candidates, &reverseCandidates };
+  search(geneSequence, from, to, strandCandidates, _strands, kernel);
+}
+
+void SimdFilter::search(const GeneSequence &geneSequence, size_t from, size_t to, std::vector<size_t> *candidates[],
+  size_t strands, Kernel kernel) const
+{
+  const unsigned char *sequence = reinterpret_cast<const unsigned char *>(geneSequence.data());
+
+  switch (kernel) {
+#ifdef HUNT_X86
+    case Kernel::AVX512:
+      from = searchAvx512(sequence, geneSequence.size(), from, to, candidates, strands);
+    break;
+    case Kernel::AVX2:
+      from = searchAvx2(sequence, geneSequence.size(), from, to, candidates, strands);
+    break;
+    case Kernel::SSE42:
+      from = searchSse42(sequence, geneSequence.size(), from, to, candidates, strands);
+    break;
+#endif
+    default:
+    break;
+  }
+
+  searchScalar(sequence, from, to, candidates, strands);
+}
+
+size_t SimdFilter::searchScalar(const unsigned char *sequence, size_t from, size_t to,
+  std::vector<size_t> *candidates[], size_t strands) const
+{
+  for (size_t pos = from; pos < to; ++pos) {
+    for (size_t strand = 0; strand < strands; ++strand) {
+      size_t mismatchFound = 0;
+
+      size_t i = 0;
+      for (; i < _size; ++i) {
+        if (!_table[strand][i][sequence[pos + i]] &&
+          (!_mismatch[strand][i] || ++mismatchFound > _maxMismatch[strand]))
+          break;
+      }
+
+      if (i == _size)
+        candidates[strand]->push_back(pos);
+    }
+  }
+
+  return to;
+}
+
+#ifdef HUNT_X86
+
+__attribute__((target("sse4.2")))
+size_t SimdFilter::searchSse42(const unsigned char *sequence, size_t length, size_t from, size_t to,
+  std::vector<size_t> *candidates[], size_t strands) const
+{
+  const size_t width = 16;
+
+  __m128i limit[MAX_STRANDS];
+  for (size_t strand = 0; strand < strands; ++strand)
+    limit[strand] = _mm_set1_epi8(static_cast<char>(_maxMismatch[strand]));
+
+  size_t pos = from;
+  for (; pos + width <= to && pos + width + _size - 1 <= length; pos += width) {
+    __m128i dead[MAX_STRANDS];
+    __m128i count[MAX_STRANDS];
+    for (size_t strand = 0; strand < strands; ++strand) {
+      dead[strand]  = _mm_setzero_si128();
+      count[strand] = _mm_setzero_si128();
+    }
+
+    // The nucleotides are loaded once and checked against the states of all the strands.
+    for (size_t i = 0; i < _size; ++i) {
+      const __m128i nucleotides = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sequence + pos + i));
+
+      for (size_t strand = 0; strand < strands; ++strand) {
+        __m128i match = _mm_setzero_si128();
+        for (size_t c = 0; c < _classSize[strand][i]; ++c)
+          match = _mm_or_si128(match, _mm_cmpeq_epi8(nucleotides, _mm_set1_epi8(_classes[strand][i][c])));
+
+        const __m128i failed = _mm_cmpeq_epi8(match, _mm_setzero_si128());
+        if (_mismatch[strand][i])
+          count[strand] = _mm_sub_epi8(count[strand], failed);
+        else
+          dead[strand] = _mm_or_si128(dead[strand], failed);
+      }
+    }
+
+    for (size_t strand = 0; strand < strands; ++strand) {
+      dead[strand] = _mm_or_si128(dead[strand], _mm_cmpgt_epi8(count[strand], limit[strand]));
+
+      unsigned survivors = ~_mm_movemask_epi8(dead[strand]) & 0xFFFF;
+      while (survivors) {
+        candidates[strand]->push_back(pos + __builtin_ctz(survivors));
+        survivors &= survivors - 1;
+      }
+    }
+  }
+
+  return pos;
+}
+
+__attribute__((target("avx2")))
+size_t SimdFilter::searchAvx2(const unsigned char *sequence, size_t length, size_t from, size_t to,
+  std::vector<size_t> *candidates[], size_t strands) const
+{
+  const size_t width = 32;
+
+  __m256i limit[MAX_STRANDS];
+  for (size_t strand = 0; strand < strands; ++strand)
+    limit[strand] = _mm256_set1_epi8(static_cast<char>(_maxMismatch[strand]));
+
+  size_t pos = from;
+  for (; pos + width <= to && pos + width + _size - 1 <= length; pos += width) {
+    __m256i dead[MAX_STRANDS];
+    __m256i count[MAX_STRANDS];
+    for (size_t strand = 0; strand < strands; ++strand) {
+      dead[strand]  = _mm256_setzero_si256();
+      count[strand] = _mm256_setzero_si256();
+    }
+
+    for (size_t i = 0; i < _size; ++i) {
+      const __m256i nucleotides = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(sequence + pos + i));
+
+      for (size_t strand = 0; strand < strands; ++strand) {
+        __m256i match = _mm256_setzero_si256();
+        for (size_t c = 0; c < _classSize[strand][i]; ++c)
+          match = _mm256_or_si256(match, _mm256_cmpeq_epi8(nucleotides, _mm256_set1_epi8(_classes[strand][i][c])));
+
+        const __m256i failed = _mm256_cmpeq_epi8(match, _mm256_setzero_si256());
+        if (_mismatch[strand][i])
+          count[strand] = _mm256_sub_epi8(count[strand], failed);
+        else
+          dead[strand] = _mm256_or_si256(dead[strand], failed);
+      }
+    }
+
+    for (size_t strand = 0; strand < strands; ++strand) {
+      dead[strand] = _mm256_or_si256(dead[strand], _mm256_cmpgt_epi8(count[strand], limit[strand]));
+
+      uint32_t survivors = ~static_cast<uint32_t>(_mm256_movemask_epi8(dead[strand]));
+      while (survivors) {
+        candidates[strand]->push_back(pos + __builtin_ctz(survivors));
+        survivors &= survivors - 1;
+      }
+    }
+  }
+
+  return pos;
+}
+
+__attribute__((target("avx512bw")))
+size_t SimdFilter::searchAvx512(const unsigned char *sequence, size_t length, size_t from, size_t to,
+  std::vector<size_t> *candidates[], size_t strands) const
+{
+  const size_t width = 64;
+  const __m512i one  = _mm512_set1_epi8(1);
+
+  __m512i limit[MAX_STRANDS];
+  for (size_t strand = 0; strand < strands; ++strand)
+    limit[strand] = _mm512_set1_epi8(static_cast<char>(_maxMismatch[strand]));
+
+  size_t pos = from;
+  for (; pos + width <= to && pos + width + _size - 1 <= length; pos += width) {
+    __mmask64 dead[MAX_STRANDS];
+    __m512i   count[MAX_STRANDS];
+    for (size_t strand = 0; strand < strands; ++strand) {
+      dead[strand]  = 0;
+      count[strand] = _mm512_setzero_si512();
+    }
+
+    for (size_t i = 0; i < _size; ++i) {
+      const __m512i nucleotides = _mm512_loadu_si512(reinterpret_cast<const void *>(sequence + pos + i));
+
+      for (size_t strand = 0; strand < strands; ++strand) {
+        __mmask64 match = 0;
+        for (size_t c = 0; c < _classSize[strand][i]; ++c)
+          match |= _mm512_cmpeq_epi8_mask(nucleotides, _mm512_set1_epi8(_classes[strand][i][c]));
+
+        if (_mismatch[strand][i])
+          count[strand] = _mm512_mask_add_epi8(count[strand], ~match, count[strand], one);
+        else
+          dead[strand] |= ~match;
+      }
+    }
+
+    for (size_t strand = 0; strand < strands; ++strand) {
+      dead[strand] |= _mm512_cmpgt_epi8_mask(count[strand], limit[strand]);
+
+      uint64_t survivors = ~static_cast<uint64_t>(dead[strand]);
+      while (survivors) {
+        candidates[strand]->push_back(pos + __builtin_ctzll(survivors));
+        survivors &= survivors - 1;
+      }
+    }
+  }
+
+  return pos;
+}
+
+#endif
@@ -0,0 +1,180 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef SIMDFILTER_H
+#define SIMDFILTER_H
+
+#include "statemachine.h"
+#include "genesequence.h"
+
+/**
+ * A vectorized filter that checks many starting positions at once against the first states of a state machine,
+ * using byte comparisons. Only the positions that survive the filter need to be fully verified. The vector kernel
+ * is picked at run time, from the instructions supported by the CPU, and all kernels find the same positions.
+ *
+ * The filter can also be built for both strands of a pattern, checking the states of the reverse complement against
+ * the same nucleotides loaded for the forward strand, so both strands are filtered in a single pass.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class SimdFilter final
+{
+  public:
+    /**
+     * The available kernels, from the slowest to the fastest.
+     *
+     */
+    enum class Kernel { SCALAR, SSE42, AVX2, AVX512 };
+
+    /**
+     * Maximum number of states checked by the filter.
+     *
+     */
+    static const size_t MAX_STATES = 16;
+
+    /**
+     * Constructor.
+     *
+     * @param stateMachine The state machine to be compiled. It must have at least one state.
+     * @param maxMismatch Maximum supported mismatches.
+     *
+     */
+    SimdFilter(const StateMachine &stateMachine, size_t maxMismatch);
+
+    /**
+     * Constructor for both strands of a pattern.
+     *
+     * @param stateMachine The state machine of the forward strand. It must have at least one state.
+     * @param reverse The state machine of the reverse strand. It must have the same number of states.
+     * @param maxMismatch Maximum supported mismatches.
+     *
+     */
+    SimdFilter(const StateMachine &stateMachine, const StateMachine &reverse, size_t maxMismatch);
+
+    /**
+     * Returns the fastest kernel supported by the CPU.
+     *
+     * @return The fastest supported kernel.
+     *
+     */
+    static Kernel best();
+
+    /**
+     * Returns if a kernel is supported by the CPU.
+     *
+     * @param kernel The kernel to be checked.
+     *
+     * @return True if the kernel is supported, otherwise false.
+     *
+     */
+    static bool supported(Kernel kernel);
+
+    /**
+     * Returns the kernel name.
+     *
+     * @param kernel The kernel.
+     *
+     * @return The kernel name, as accepted by parse().
+     *
+     */
+    static const char *name(Kernel kernel);
+
+    /**
+     * Returns the kernel with a name.
+     *
+     * @param name Kernel name: scalar, sse4.2, avx2 or avx512.
+     * @param kernel Will receive the kernel.
+     *
+     * @return True if the name is valid, otherwise false.
+     *
+     */
+    static bool parse(const std::string &name, Kernel &kernel);
+
+    /**
+     * Find the starting positions, inside a range, that survive the filter.
+     *
+     * @param geneSequence The sequence to be scanned.
+     * @param from First starting position to be checked.
+     * @param to Position after the last starting position to be checked. The nucleotides checked from these positions
+     *           must be inside the sequence.
+     * @param candidates Vector that will receive the surviving positions, in ascending order.
+     * @param kernel The kernel to be used. It must be supported by the CPU.
+     *
+     */
+    void search(const GeneSequence &geneSequence, size_t from, size_t to, std::vector<size_t> &candidates,
+      Kernel kernel) const;
+
+    /**
+     * Find the starting positions, inside a range, that survive the filter of each strand. The filter must have been
+     * built for both strands.
+     *
+     * @param geneSequence The sequence to be scanned.
+     * @param from First starting position to be checked.
+     * @param to Position after the last starting position to be checked. The nucleotides checked from these positions
+     *           must be inside the sequence.
+     * @param candidates Vector that will receive the surviving positions of the forward strand, in ascending order.
+     * @param reverseCandidates Vector that will receive the surviving positions of the reverse strand, in ascending
+     *                          order.
+     * @param kernel The kernel to be used. It must be supported by the CPU.
+     *
+     */
+    void search(const GeneSequence &geneSequence, size_t from, size_t to, std::vector<size_t> &candidates,
+      std::vector<size_t> &reverseCandidates, Kernel kernel) const;
+
+  private:
+    /**
+     * Maximum number of strands filtered in the same pass.
+     *
+     */
+    static const size_t MAX_STRANDS = 2;
+
+    size_t _strands;
+    size_t _size;
+    size_t _maxMismatch[MAX_STRANDS];
+    bool   _mismatch[MAX_STRANDS][MAX_STATES];
+    bool   _table[MAX_STRANDS][MAX_STATES][256];
+    char   _classes[MAX_STRANDS][MAX_STATES][4];
+    size_t _classSize[MAX_STRANDS][MAX_STATES];
+
+    /**
+     * Helper to compile the first states of the state machine of a strand.
+     *
+     */
+    void compile(size_t strand, const StateMachine &stateMachine, size_t maxMismatch);
+
+    /**
+     * Helper to run the kernels for the first strands, with one vector of candidates per strand.
+     *
+     */
+    void search(const GeneSequence &geneSequence, size_t from, size_t to, std::vector<size_t> *candidates[],
+      size_t strands, Kernel kernel) const;
+
+    /**
+     * Kernels, returning the position where they stopped.
+     *
+     */
+    size_t searchScalar(const unsigned char *sequence, size_t from, size_t to, std::vector<size_t> *candidates[],
+      size_t strands) const;
+    size_t searchSse42(const unsigned char *sequence, size_t length, size_t from, size_t to,
+      std::vector<size_t> *candidates[], size_t strands) const;
+    size_t searchAvx2(const unsigned char *sequence, size_t length, size_t from, size_t to,
+      std::vector<size_t> *candidates[], size_t strands) const;
+    size_t searchAvx512(const unsigned char *sequence, size_t length, size_t from, size_t to,
+      std::vector<size_t> *candidates[], size_t strands) const;
+};
+
+#endif
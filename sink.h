@@ -0,0 +1,89 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef SINK_H
+#define SINK_H
+
+#include <vector>
+#include <string>
+
+#include "hit.h"
+#include "genesource.h"
+
+/**
+ * Destination of the matches found on each sequence gene. Each format of the results is a different sink, and the
+ * sequence genes are given to it one at a time, as soon as they are matched.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class Sink
+{
+  public:
+    /**
+     * Destructor.
+     *
+     */
+    virtual ~Sink()
+    {
+    }
+
+    /**
+     * Tell if the sink writes the sequences, so it needs the positions to be marked. Otherwise only the hits are
+     * used, and they can be found without the marks.
+     *
+     * @return True if the positions to be marked are used, otherwise false.
+     *
+     */
+    virtual bool needsMarks() const
+    {
+      return false;
+    }
+
+    /**
+     * Write the beginning of the results.
+     *
+     * @param commandLine Command line passed to execute the process.
+     *
+     */
+    virtual void createHeader(const std::string &commandLine) = 0;
+
+    /**
+     * Write the matches of a sequence gene.
+     *
+     * @param geneName Processed sequence gene name.
+     * @param recordName Name of the record holding the sequence gene. It is the gene name, unless only a region of the
+     * record was matched.
+     * @param offset Position of the first nucleotide of the sequence gene in the record, 0 unless only a region of the
+     * record was matched.
+     * @param geneSource Sequence of nucleotides used in the match.
+     * @param positions Positions where there was a pattern match or nucleotide mismatch.
+     * @param hit A list of matches, grouped by state machine.
+     *
+     */
+    virtual void appendGene(const std::string &geneName, const std::string &recordName, size_t offset,
+      const GeneSource &geneSource, const std::vector<PositionToMark> &positions, const std::vector<HIT> &hit) = 0;
+
+    /**
+     * Write the end of the results.
+     *
+     * @param numberOfElements Number of sequence genes with matches.
+     *
+     */
+    virtual void createFooter(size_t numberOfElements) = 0;
+};
+
+#endif
@@ -0,0 +1,93 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "skipmatcher.h"
+
+#include <algorithm>
+
+const size_t SkipMatcher::MAX_STATES;
+const size_t SkipMatcher::GRAM;
+
+SkipMatcher::SkipMatcher(const StateMachine &stateMachine) : _size(std::min(stateMachine.size(), MAX_STATES))
+{
+  compile(0, stateMachine);
+}
+
+SkipMatcher::SkipMatcher(const StateMachine &stateMachine, const StateMachine &reverse) :
+  _size(std::min(stateMachine.size(), MAX_STATES))
+{
+  compile(0, stateMachine);
+  compile(1, reverse);
+}
+
+void SkipMatcher::compile(size_t strand, const StateMachine &stateMachine)
+{
+  for (size_t c = 0; c < 256; ++c) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < _size; ++i) {
+      if (stateMachine.state(i).contains(static_cast<char>(c)))
+        mask |= 1ULL << (_size - 1 - i);
+    }
+
+    _masks[strand][c] = mask;
+  }
+}
+
+void SkipMatcher::search(const GeneSequence &geneSequence, size_t from, size_t to,
+  std::vector<size_t> &candidates) const
+{
+  search(0, geneSequence, from, to, candidates);
+}
+
+void SkipMatcher::search(const GeneSequence &geneSequence, size_t from, size_t to, std::vector<size_t> &candidates,
+  std::vector<size_t> &reverseCandidates) const
+{
+  search(0, geneSequence, from, to, candidates);
+  search(1, geneSequence, from, to, reverseCandidates);
+}
+
+void SkipMatcher::search(size_t strand, const GeneSequence &geneSequence, size_t from, size_t to,
+  std::vector<size_t> &candidates) const
+{
+  if (_size == 0)
+    return;
+
+  const unsigned char *sequence = reinterpret_cast<const unsigned char *>(geneSequence.data());
+  const uint64_t      *masks    = _masks[strand];
+  const uint64_t       all      = _size == 64 ? ~0ULL : (1ULL << _size) - 1;
+  const size_t         gram     = std::min(_size, GRAM);
+
+  for (size_t window = from; window < to;) {
+    // The last nucleotides of the window are read at once, most windows can be skipped right after them.
+    uint64_t state = all;
+    for (size_t i = 1; i <= gram; ++i)
+      state &= masks[sequence[window + _size - i]] << (gram - i);
+    state &= all;
+
+    // Once no state can begin the nucleotides read, no match begins up to the last nucleotide read, and a state
+    // surviving the whole window is the first one, so the window matches.
+    size_t j = _size - gram;
+    while (state != 0 && j > 0)
+      state = (state << 1) & all & masks[sequence[window + --j]];
+
+    if (state != 0) {
+      candidates.push_back(window);
+      ++window;
+    }
+    else
+      window += j + 1;
+  }
+}
@@ -0,0 +1,120 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef SKIPMATCHER_H
+#define SKIPMATCHER_H
+
+#include "statemachine.h"
+#include "genesequence.h"
+
+/**
+ * Simplified backward nondeterministic DAWG matching (SBNDM) of the first states of a state machine, for the state
+ * machines matched without mismatches. Each window of the gene sequence is read backwards, keeping the set of states
+ * where the nucleotides read so far may be beginning, and once the set is empty the window jumps past the first
+ * nucleotide read, so each step may skip up to the number of states checked. The last nucleotides of a window are read
+ * at once, as with only four nucleotides a single one rarely ends the search.
+ *
+ * The states are checked as character classes, so the ORs and the N states are supported. The matcher can also be
+ * built for both strands of a pattern, each strand being searched in its own pass.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class SkipMatcher final
+{
+  public:
+    /**
+     * Maximum number of states checked by the matcher.
+     *
+     */
+    static const size_t MAX_STATES = 64;
+
+    /**
+     * Number of nucleotides read at once at the end of each window.
+     *
+     */
+    static const size_t GRAM = 4;
+
+    /**
+     * Constructor.
+     *
+     * @param stateMachine The state machine to be compiled.
+     *
+     */
+    SkipMatcher(const StateMachine &stateMachine);
+
+    /**
+     * Constructor for both strands of a pattern.
+     *
+     * @param stateMachine The state machine of the forward strand.
+     * @param reverse The state machine of the reverse strand. It must have the same number of states.
+     *
+     */
+    SkipMatcher(const StateMachine &stateMachine, const StateMachine &reverse);
+
+    /**
+     * Find the starting positions, inside a range, where the first states match without mismatches.
+     *
+     * @param geneSequence The sequence to be scanned.
+     * @param from First starting position to be checked.
+     * @param to Position after the last starting position to be checked. The nucleotides checked from these positions
+     *           must be inside the sequence.
+     * @param candidates Vector that will receive the matching positions, in ascending order.
+     *
+     */
+    void search(const GeneSequence &geneSequence, size_t from, size_t to, std::vector<size_t> &candidates) const;
+
+    /**
+     * Find the starting positions, inside a range, where the first states of each strand match without mismatches.
+     * The matcher must have been built for both strands.
+     *
+     * @param geneSequence The sequence to be scanned.
+     * @param from First starting position to be checked.
+     * @param to Position after the last starting position to be checked. The nucleotides checked from these positions
+     *           must be inside the sequence.
+     * @param candidates Vector that will receive the matching positions of the forward strand, in ascending order.
+     * @param reverseCandidates Vector that will receive the matching positions of the reverse strand, in ascending
+     *                          order.
+     *
+     */
+    void search(const GeneSequence &geneSequence, size_t from, size_t to, std::vector<size_t> &candidates,
+      std::vector<size_t> &reverseCandidates) const;
+
+  private:
+    /**
+     * Maximum number of strands of a matcher.
+     *
+     */
+    static const size_t MAX_STRANDS = 2;
+
+    size_t   _size;
+    uint64_t _masks[MAX_STRANDS][256];
+
+    /**
+     * Helper to compile the states of a strand, the first state in the highest bit.
+     *
+     */
+    void compile(size_t strand, const StateMachine &stateMachine);
+
+    /**
+     * Helper to search the states of a strand.
+     *
+     */
+    void search(size_t strand, const GeneSequence &geneSequence, size_t from, size_t to,
+      std::vector<size_t> &candidates) const;
+};
+
+#endif
@@ -58,9 +58,15 @@ State &State::operator=(const State &obj)
   return *this;
 }
 
-StateMachine::StateMachine(const std::string &label, const std::string &pattern, uint16_t minNumberOfPatterns, char strand) : _label(label),
-  _pattern(pattern), _minNumberOfPatterns(minNumberOfPatterns), _strand(strand)
+StateMachine::StateMachine(const std::string &label, const std::string &pattern, uint16_t minNumberOfPatterns, char strand)
 {
+  std::shared_ptr<Data> data = std::make_shared<Data>();
+  data->label               = label;
+  data->pattern             = pattern;
+  data->strand              = strand;
+  data->minNumberOfPatterns = minNumberOfPatterns;
+
+  std::vector<State> &states = data->states;
   std::string currentNucleotides;
 
   bool hasParenthesis = false;
@@ -73,12 +79,12 @@ StateMachine::StateMachine(const std::string &label, const std::string &pattern,
       case 'G':
         currentNucleotides += nucleotide;
         if (!hasBrackets) {
-          _states.push_back(State(currentNucleotides, !hasParenthesis));
+          states.push_back(State(currentNucleotides, !hasParenthesis));
           currentNucleotides.clear();
         }
       break;
       case 'N':
-        _states.push_back(State("ACTG", !hasParenthesis));
+        states.push_back(State("ACTG", !hasParenthesis));
         currentNucleotides.clear();
       break;
       case '(':
@@ -103,7 +109,7 @@ StateMachine::StateMachine(const std::string &label, const std::string &pattern,
         if (currentNucleotides.empty())
           throw ParseException("Not enough elements inside the brackets");
 
-        _states.push_back(State(currentNucleotides, !hasParenthesis));
+        states.push_back(State(currentNucleotides, !hasParenthesis));
         currentNucleotides.clear();
         hasBrackets = false;
       break;
@@ -118,69 +124,155 @@ StateMachine::StateMachine(const std::string &label, const std::string &pattern,
     }
   }
 
-  if (!_states.empty())
-    _states.back().setFinalState();
+  if (!states.empty())
+    states.back().setFinalState();
+
+  _data = data;
+}
+
+StateMachine::StateMachine(const StateMachine &obj) : _data(obj._data)
+{
 }
 
-StateMachine::StateMachine(const StateMachine &obj)
+StateMachine::StateMachine(const std::shared_ptr<const Data> &data) : _data(data)
 {
-  _pattern             = obj._pattern;
-  _label               = obj._label;
-  _strand              = obj._strand;
-  _states              = obj._states;
-  _minNumberOfPatterns = obj._minNumberOfPatterns;
 }
 
-void StateMachine::restart() const
+StateMachine StateMachine::slice(size_t begin, size_t length) const
 {
-  if (!_states.empty())
-    _currState = 0;
-  else
-    _currState = -1;
+  std::shared_ptr<Data> data = std::make_shared<Data>(*_data);
+
+  data->states.assign(_data->states.begin() + begin, _data->states.begin() + begin + length);
+  data->states.back().setFinalState();
+
+  return StateMachine(data);
 }
 
 bool StateMachine::checkNumberOfPatterns(const std::vector<HIT> &hit) const
 {
-  return hit.size() >= _minNumberOfPatterns;
+  return hit.size() >= _data->minNumberOfPatterns;
+}
+
+size_t StateMachine::size() const
+{
+  return _data->states.size();
 }
 
-const State *StateMachine::nextState() const
+const State &StateMachine::state(size_t idx) const
 {
-  const State *ret = nullptr;
-  if (_states.size() > _currState && _currState != -1) {
-    ret = &_states.at(_currState);
-    ++_currState;
+  return _data->states.at(idx);
+}
+
+StateMachine StateMachine::reverseComplement() const
+{
+  return StateMachine(_data->label, complement(_data->pattern), _data->minNumberOfPatterns,
+    _data->strand == '-' ? '+' : '-');
+}
+
+bool StateMachine::isPalindrome() const
+{
+  const char nucleotides[] = { 'A', 'C', 'G', 'T' };
+  const StateMachine reverse = reverseComplement();
+
+  if (reverse.size() != size())
+    return false;
+
+  for (size_t i = 0; i < size(); ++i) {
+    const State &state        = _data->states[i];
+    const State &reverseState = reverse.state(i);
+    if (state.acceptMismatch() != reverseState.acceptMismatch())
+      return false;
+
+    for (auto nucleotide : nucleotides) {
+      if (state.contains(nucleotide) != reverseState.contains(nucleotide))
+        return false;
+    }
   }
 
-  return ret;
+  return true;
 }
 
-size_t StateMachine::size() const
+std::string StateMachine::complement(const std::string &pattern)
 {
-  return _states.size();
+  std::string ret;
+  for (size_t i = pattern.size(); i > 0; --i) {
+    char ch = pattern.at(i - 1);
+    switch(ch) {
+      case 'A':
+        ret += 'T';
+      break;
+      case 'C':
+        ret += 'G';
+      break;
+      case 'G':
+        ret += 'C';
+      break;
+      case 'T':
+        ret += 'A';
+      break;
+      case '(':
+        ret += ')';
+      break;
+      case ')':
+        ret += '(';
+      break;
+      case '[':
+        ret += ']';
+      break;
+      case ']':
+        ret += '[';
+      break;
+      case 'N':
+        ret += 'N';
+      break;
+    }
+  }
+
+  return ret;
 }
 
 const std::string &StateMachine::label() const
 {
-  return _label;
+  return _data->label;
 }
 
 const std::string &StateMachine::pattern() const
 {
-  return _pattern;
+  return _data->pattern;
+}
+
+uint16_t StateMachine::minNumberOfPatterns() const
+{
+  return _data->minNumberOfPatterns;
 }
 
 char StateMachine::strand() const
 {
-  return _strand;
+  return _data->strand;
 }
 
 StateMachine &StateMachine::operator=(const StateMachine &obj)
 {
-  _pattern             = obj._pattern;
-  _label               = obj._label;
-  _strand              = obj._strand;
-  _states              = obj._states;
-  _minNumberOfPatterns = obj._minNumberOfPatterns;
+  _data = obj._data;
   return *this;
 }
+
+StateCursor::StateCursor(const StateMachine &stateMachine) : _stateMachine(stateMachine)
+{
+}
+
+void StateCursor::restart()
+{
+  _currState = 0;
+}
+
+const State *StateCursor::nextState()
+{
+  const State *ret = nullptr;
+  if (_currState < _stateMachine.size()) {
+    ret = &_stateMachine.state(_currState);
+    ++_currState;
+  }
+
+  return ret;
+}
@@ -19,6 +19,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <exception>
 
 class HIT;
@@ -133,6 +134,9 @@ class State final
  * This is a state machine class that supports the ACGT nucleotides and also some OR, and protection mechanisms to
  * looking for a pattern matches inside a gene sequence.
  *
+ * A state machine is immutable once it is parsed, and its copies share the parsed states, so it can be copied around
+ * and used by several threads at the same time. The position of a walk through the states is kept by a StateCursor.
+ *
  * @author Leonardo Bispo de Oliveira.
  *
  */
@@ -162,36 +166,72 @@ class StateMachine final
     StateMachine(const StateMachine &obj);
 
     /**
-     * Restart the state machine to the initial state.
+     * Check if the number of found matches are the minimum required for this state machine.
+     *
+     * @param hit A hit vector to check if the size is great equal than the minimum number of patterns.
+     *
+     * @return True if number of hits are great equal than the minimum number of patterns.
      *
      */
-    void restart() const;
+    bool checkNumberOfPatterns(const std::vector<HIT> &hit) const;
 
     /**
-     * Return the current state and forward the state machine to the next one.
+     * Returns the number of states in this state machine.
      *
-     * @return Current state.
+     * @return Number of states in this state machine.
      *
      */
-    const State *nextState() const;
+    size_t size() const;
 
     /**
-     * Check if the number of found matches are the minimum required for this state machine.
+     * Returns a state of this state machine.
      *
-     * @param hit A hit vector to check if the size is great equal than the minimum number of patterns.
+     * @param idx Index of the state, from 0 to size() - 1.
      *
-     * @return True if number of hits are great equal than the minimum number of patterns.
+     * @return The state at the requested index.
      *
      */
-    bool checkNumberOfPatterns(const std::vector<HIT> &hit) const;
+    const State &state(size_t idx) const;
 
     /**
-     * Returns the number of states in this state machine.
+     * Returns a state machine made of a piece of the states of this one. It keeps the label, pattern and strand of
+     * this state machine.
      *
-     * @return Number of states in this state machine.
+     * @param begin Index of the first state of the piece.
+     * @param length Number of states in the piece, at least 1.
+     *
+     * @return The state machine with the piece of the states.
      *
      */
-    size_t size() const;
+    StateMachine slice(size_t begin, size_t length) const;
+
+    /**
+     * Returns the state machine of the reverse complement of this pattern, for the other strand. It keeps the label
+     * and the minimum number of patterns.
+     *
+     * @return The state machine of the reverse complement.
+     *
+     */
+    StateMachine reverseComplement() const;
+
+    /**
+     * Returns if the pattern is its own reverse complement: both state machines have the same states, so they match
+     * the same positions with the same mismatches.
+     *
+     * @return True if the pattern is palindromic, otherwise false.
+     *
+     */
+    bool isPalindrome() const;
+
+    /**
+     * Returns the reverse complement of a pattern.
+     *
+     * @param pattern A valid pattern.
+     *
+     * @return The pattern of the other strand.
+     *
+     */
+    static std::string complement(const std::string &pattern);
 
     /**
      * Returns the name identification of this state machine.
@@ -209,6 +249,14 @@ class StateMachine final
      */
     const std::string &pattern() const;
 
+    /**
+     * Returns the minimum number of patterns that must match to be considered a gene sequence found.
+     *
+     * @return The minimum number of patterns.
+     *
+     */
+    uint16_t minNumberOfPatterns() const;
+
     /**
      * Returns the strand that this pattern is related.
      *
@@ -228,13 +276,63 @@ class StateMachine final
     StateMachine &operator=(const StateMachine &obj);
 
   private:
-    std::string _label;
-    std::string _pattern;
-    char        _strand;
-    uint16_t    _minNumberOfPatterns;
+    /**
+     * The parsed state machine, shared by all the copies.
+     *
+     */
+    struct Data
+    {
+      std::string        label;
+      std::string        pattern;
+      char               strand;
+      uint16_t           minNumberOfPatterns;
+      std::vector<State> states;
+    };
+
+    std::shared_ptr<const Data> _data;
+
+    /**
+     * Constructor from already parsed states.
+     *
+     */
+    StateMachine(const std::shared_ptr<const Data> &data);
+};
+
+/**
+ * A walk through the states of a state machine. It is cheap to create, so each thread can have its own cursors over
+ * the same state machine.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class StateCursor final
+{
+  public:
+    /**
+     * Constructor. The cursor starts at the initial state.
+     *
+     * @param stateMachine The state machine to be walked. It must outlive the cursor.
+     *
+     */
+    StateCursor(const StateMachine &stateMachine);
+
+    /**
+     * Restart the cursor to the initial state.
+     *
+     */
+    void restart();
 
-    std::vector<State> _states;
-    mutable int        _currState = -1;
+    /**
+     * Return the current state and forward the cursor to the next one.
+     *
+     * @return Current state, or nullptr if there are no more states.
+     *
+     */
+    const State *nextState();
+
+  private:
+    const StateMachine &_stateMachine;
+    size_t              _currState = 0;
 };
 
 #endif
@@ -16,8 +16,10 @@
  */
 #include "summary.h"
 
-Summary::Summary(const std::string &fileName)
+Summary::Summary(const std::string &fileName, const std::vector<StateMachine> &patterns) : _buffer(BUFFER_SIZE),
+  _patterns(patterns)
 {
+  _os.rdbuf()->pubsetbuf(_buffer.data(), _buffer.size());
   _os.open(fileName + "_summary.html");
 }
 
@@ -28,101 +30,104 @@ Summary::~Summary()
 
 void Summary::createHeader(const std::string &commandLine)
 {
-  _os << "<html>" << std::endl;
-  _os << "<p>" << std::endl << "<font size=2>" << std::endl;
-  _os << "search-parameters:" << std::endl  << std::endl;
-  _os << commandLine << std::endl;
-  _os << "</font></p>" << std::endl;
+  _os << "<html>" << '\n';
+  _os << "<p>" << '\n' << "<font size=2>" << '\n';
+  _os << "search-parameters:" << '\n'  << '\n';
+  _os << commandLine << '\n';
+  _os << "</font></p>" << '\n';
 
   _os << "  <br>";
-  _os << "  <body>" << std::endl << "    <table border=\"1\">" << std::endl;
-  _os << "      <tr>" << std::endl;
-  _os << "        <td>" << std::endl;
-  _os << "         <h5><center> Sequence Name</center></h5>" << std::endl;
-  _os << "        </td>" << std::endl;
-  _os << "        <td>" << std::endl;
-  _os << "         <h5><center> Hit Pattern</center></h5>" << std::endl; 
-  _os << "        </td>" << std::endl;
-  _os << "        <td>" << std::endl;
-  _os << "         <h5><center> P_ositions</center></h5>" << std::endl; 
-  _os << "        </td>" << std::endl;
-  _os << "      </tr>" << std::endl;
+  _os << "  <body>" << '\n' << "    <table border=\"1\">" << '\n';
+  _os << "      <tr>" << '\n';
+  _os << "        <td>" << '\n';
+  _os << "         <h5><center> Sequence Name</center></h5>" << '\n';
+  _os << "        </td>" << '\n';
+  _os << "        <td>" << '\n';
+  _os << "         <h5><center> Hit Pattern</center></h5>" << '\n'; 
+  _os << "        </td>" << '\n';
+  _os << "        <td>" << '\n';
+  _os << "         <h5><center> P_ositions</center></h5>" << '\n'; 
+  _os << "        </td>" << '\n';
+  _os << "      </tr>" << '\n';
 }
 
 void Summary::appendGene(const std::string &geneName, const std::vector<HIT> &hit)
 {
-  _os << "      <tr>" << std::endl;
-  _os << "        <td>" << std::endl;
-  _os << "          " << geneName << std::endl; 
-  _os << "        </td>" << std::endl;
+  _os << "      <tr>" << '\n';
+  _os << "        <td>" << '\n';
+  _os << "          " << geneName << '\n'; 
+  _os << "        </td>" << '\n';
 
-  _os << "        <td>" << std::endl;
-  _os << "          <table border=\"1\" width=\"100%\">" << std::endl; 
+  _os << "        <td>" << '\n';
+  _os << "          <table border=\"1\" width=\"100%\">" << '\n'; 
 
-  _os << "            <tr>" << std::endl;
-  _os << "              <td>" << std::endl;
-  _os << "                Name" << std::endl; 
-  _os << "              </td>" << std::endl;
-  _os << "              <td>" << std::endl;
-  _os << "                Match" << std::endl; 
-  _os << "              </td>" << std::endl;
-  _os << "              <td>" << std::endl;
-  _os << "                Mismatch" << std::endl;
-  _os << "              </td>" << std::endl;
-  _os << "              <td>" << std::endl;
-  _os << "                Strand" << std::endl; 
-  _os << "              </td>" << std::endl;
-  _os << "            </tr>" << std::endl;
+  _os << "            <tr>" << '\n';
+  _os << "              <td>" << '\n';
+  _os << "                Name" << '\n'; 
+  _os << "              </td>" << '\n';
+  _os << "              <td>" << '\n';
+  _os << "                Match" << '\n'; 
+  _os << "              </td>" << '\n';
+  _os << "              <td>" << '\n';
+  _os << "                Mismatch" << '\n';
+  _os << "              </td>" << '\n';
+  _os << "              <td>" << '\n';
+  _os << "                Strand" << '\n'; 
+  _os << "              </td>" << '\n';
+  _os << "            </tr>" << '\n';
 
   for (auto &h : hit) {
-    _os << "            <tr>" << std::endl;
-    _os << "              <td>" << std::endl;
-    _os << "                " << h.stateMachine().label() << std::endl; 
-    _os << "              </td>" << std::endl;
-    _os << "              <td>" << std::endl;
-    _os << "                " << h.stateMachine().pattern() << std::endl; 
-    _os << "              </td>" << std::endl;
-    _os << "              <td>" << std::endl;
-    _os << "                " << h.numberMismatches() << std::endl;
-    _os << "              </td>" << std::endl;
-    _os << "              <td>" << std::endl;
-    _os << "                " << h.stateMachine().strand() << std::endl; 
-    _os << "              </td>" << std::endl;
-    _os << "            </tr>" << std::endl;
+    const StateMachine &stateMachine = _patterns.at(h.patternId());
+
+    _os << "            <tr>" << '\n';
+    _os << "              <td>" << '\n';
+    _os << "                " << stateMachine.label() << '\n'; 
+    _os << "              </td>" << '\n';
+    _os << "              <td>" << '\n';
+    _os << "                " << stateMachine.pattern() << '\n'; 
+    _os << "              </td>" << '\n';
+    _os << "              <td>" << '\n';
+    _os << "                " << h.numberMismatches() << '\n';
+    _os << "              </td>" << '\n';
+    _os << "              <td>" << '\n';
+    _os << "                " << stateMachine.strand() << '\n'; 
+    _os << "              </td>" << '\n';
+    _os << "            </tr>" << '\n';
   }
 
-  _os << "          </table>" << std::endl; 
-  _os << "        </td>" << std::endl;
+  _os << "          </table>" << '\n'; 
+  _os << "        </td>" << '\n';
       
-  _os << "        <td>" << std::endl;
-  _os << "          <table border=\"1\" width=\"100%\">" << std::endl; 
-  _os << "            <tr>" << std::endl;
-  _os << "              <td>" << std::endl;
-  _os << "                Start" << std::endl; 
-  _os << "              </td>" << std::endl;
-  _os << "              <td>" << std::endl;
-  _os << "                End" << std::endl; 
-  _os << "              </td>" << std::endl;
-  _os << "            </tr>" << std::endl;
+  _os << "        <td>" << '\n';
+  _os << "          <table border=\"1\" width=\"100%\">" << '\n'; 
+  _os << "            <tr>" << '\n';
+  _os << "              <td>" << '\n';
+  _os << "                Start" << '\n'; 
+  _os << "              </td>" << '\n';
+  _os << "              <td>" << '\n';
+  _os << "                End" << '\n'; 
+  _os << "              </td>" << '\n';
+  _os << "            </tr>" << '\n';
 
   for (auto &h : hit) {
-    _os << "            <tr>" << std::endl;
-    _os << "              <td>" << std::endl;
-    _os << "                " << h.begin() << std::endl; 
-    _os << "              </td>" << std::endl;
-    _os << "              <td>" << std::endl;
-    _os << "                " << h.end() << std::endl; 
-    _os << "              </td>" << std::endl;
-    _os << "            </tr>" << std::endl;
+    _os << "            <tr>" << '\n';
+    _os << "              <td>" << '\n';
+    _os << "                " << h.begin() << '\n'; 
+    _os << "              </td>" << '\n';
+    _os << "              <td>" << '\n';
+    _os << "                " << h.end() << '\n'; 
+    _os << "              </td>" << '\n';
+    _os << "            </tr>" << '\n';
   }
-  _os << "          </table>" << std::endl; 
-  _os << "        </td>" << std::endl;
-  _os << "      </tr>" << std::endl;
+  _os << "          </table>" << '\n'; 
+  _os << "        </td>" << '\n';
+  _os << "      </tr>" << '\n';
 }
 
 void Summary::createFooter(size_t numberOfElements)
 {
-  _os << "    </table>" << std::endl;
-  _os << "<br> Number of targets sequences: " << numberOfElements << std::endl; 
-  _os << " </body></html>" << std::endl;
+  _os << "    </table>" << '\n';
+  _os << "<br> Number of targets sequences: " << numberOfElements << '\n'; 
+  _os << " </body></html>" << '\n';
+  _os.flush();
 }
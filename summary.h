@@ -36,9 +36,10 @@ class Summary final
      * Constructor.
      *
      * @param fileName Summary file name to be created.
+     * @param patterns Pattern table used to find the state machine of each hit. It must outlive this object.
      *
      */
-    Summary(const std::string &fileName);
+    Summary(const std::string &fileName, const std::vector<StateMachine> &patterns);
 
     /**
      * Destructor.
@@ -72,7 +73,15 @@ class Summary final
     void createFooter(size_t numberOfElements);
 
   private:
-    std::ofstream _os;
+    /**
+     * Size of the buffer used to write the file. It is only flushed when full and when the file is finished.
+     *
+     */
+    static const size_t BUFFER_SIZE = 1 << 20;
+
+    std::vector<char>                _buffer;
+    std::ofstream                    _os;
+    const std::vector<StateMachine> &_patterns;
 };
 
 #endif
@@ -0,0 +1,122 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include "tabularsink.h"
+#include "hunt.h"
+#include "fastaindex.h"
+
+TabularSink::TabularSink(const std::string &fileName, const std::vector<StateMachine> &patterns) :
+  _buffer(BUFFER_SIZE), _fileName(fileName), _patterns(patterns)
+{
+  _os.rdbuf()->pubsetbuf(_buffer.data(), _buffer.size());
+  _os.open(fileName);
+  if (!_os)
+    throw HunTException("Problems to create the output file: " + _fileName);
+}
+
+TabularSink::~TabularSink()
+{
+  _os.close();
+}
+
+void TabularSink::createFooter(size_t)
+{
+  if (!_os.flush())
+    throw HunTException("Problems to write the output file: " + _fileName);
+}
+
+BedSink::BedSink(const std::string &fileName, const std::vector<StateMachine> &patterns) :
+  TabularSink(fileName + ".bed", patterns)
+{
+}
+
+void BedSink::createHeader(const std::string &)
+{
+}
+
+void BedSink::appendGene(const std::string &, const std::string &recordName, size_t offset, const GeneSource &,
+  const std::vector<PositionToMark> &, const std::vector<HIT> &hit)
+{
+  const std::string id = FastaIndex::sequenceId(recordName);
+
+  for (auto &h : hit) {
+    const StateMachine &stateMachine = _patterns.at(h.patternId());
+    _os << id << '\t' << offset + h.begin() << '\t' << offset + h.end() + 1 << '\t' << stateMachine.label() << '\t'
+      << h.numberMismatches() << '\t' << stateMachine.strand() << '\n';
+  }
+}
+
+Gff3Sink::Gff3Sink(const std::string &fileName, const std::vector<StateMachine> &patterns) :
+  TabularSink(fileName + ".gff3", patterns)
+{
+}
+
+void Gff3Sink::createHeader(const std::string &)
+{
+  _os << "##gff-version 3" << '\n';
+}
+
+void Gff3Sink::appendGene(const std::string &, const std::string &recordName, size_t offset, const GeneSource &,
+  const std::vector<PositionToMark> &, const std::vector<HIT> &hit)
+{
+  const std::string id = FastaIndex::sequenceId(recordName);
+
+  for (auto &h : hit) {
+    const StateMachine &stateMachine = _patterns.at(h.patternId());
+
+    _os << id << "\thunT\tnucleotide_motif\t" << offset + h.begin() + 1 << '\t' << offset + h.end() + 1 << '\t'
+      << h.numberMismatches() << '\t' << stateMachine.strand() << "\t.\tName=";
+    writeEscaped(stateMachine.label());
+    _os << ";pattern=";
+    writeEscaped(stateMachine.pattern());
+    _os << ";mismatches=" << h.numberMismatches() << '\n';
+  }
+}
+
+void Gff3Sink::writeEscaped(const std::string &value)
+{
+  static const char hex[] = "0123456789ABCDEF";
+
+  for (auto ch : value) {
+    const unsigned char byte = ch;
+    if (byte < 0x20 || byte == 0x7f || ch == ';' || ch == '=' || ch == '&' || ch == ',' || ch == '%')
+      _os << '%' << hex[byte >> 4] << hex[byte & 0xf];
+    else
+      _os << ch;
+  }
+}
+
+TsvSink::TsvSink(const std::string &fileName, const std::vector<StateMachine> &patterns) :
+  TabularSink(fileName + ".tsv", patterns)
+{
+}
+
+void TsvSink::createHeader(const std::string &)
+{
+  _os << "#sequence\tlabel\tpattern\tstrand\tbegin\tend\tmismatches" << '\n';
+}
+
+void TsvSink::appendGene(const std::string &, const std::string &recordName, size_t offset, const GeneSource &,
+  const std::vector<PositionToMark> &, const std::vector<HIT> &hit)
+{
+  const std::string id = FastaIndex::sequenceId(recordName);
+
+  for (auto &h : hit) {
+    const StateMachine &stateMachine = _patterns.at(h.patternId());
+    _os << id << '\t' << stateMachine.label() << '\t' << stateMachine.pattern() << '\t' << stateMachine.strand()
+      << '\t' << offset + h.begin() << '\t' << offset + h.end() << '\t' << h.numberMismatches() << '\n';
+  }
+}
@@ -0,0 +1,173 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef TABULARSINK_H
+#define TABULARSINK_H
+
+#include <fstream>
+
+#include "sink.h"
+
+/**
+ * Base of the sinks writing one line per hit to a tab separated file. The sequences are never held, and the file is
+ * written through a large buffer.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class TabularSink : public Sink
+{
+  public:
+    /**
+     * Constructor. A HunTException is fired if the file cannot be created.
+     *
+     * @param fileName Output file name to be created.
+     * @param patterns Pattern table used to find the state machine of each hit. It must outlive this object.
+     *
+     */
+    TabularSink(const std::string &fileName, const std::vector<StateMachine> &patterns);
+
+    /**
+     * Destructor.
+     *
+     */
+    ~TabularSink();
+
+    /**
+     * Write the buffered lines to the file. A HunTException is fired if it cannot be written.
+     *
+     */
+    void createFooter(size_t numberOfElements);
+
+  protected:
+    /**
+     * Size of the buffer used to write the file. It is only flushed when full and when the file is finished.
+     *
+     */
+    static const size_t BUFFER_SIZE = 1 << 20;
+
+    std::vector<char>                _buffer;
+    std::string                      _fileName;
+    std::ofstream                    _os;
+    const std::vector<StateMachine> &_patterns;
+};
+
+/**
+ * Sink writing a BED6 file: sequence id, 0-based begin, end, label, number of mismatches as the score, and strand.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class BedSink final : public TabularSink
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param fileName Output file name to be created, without the extension.
+     * @param patterns Pattern table used to find the state machine of each hit. It must outlive this object.
+     *
+     */
+    BedSink(const std::string &fileName, const std::vector<StateMachine> &patterns);
+
+    /**
+     * BED files have no header.
+     *
+     */
+    void createHeader(const std::string &commandLine);
+
+    /**
+     * Append one line for each hit.
+     *
+     */
+    void appendGene(const std::string &geneName, const std::string &recordName, size_t offset,
+      const GeneSource &geneSource, const std::vector<PositionToMark> &positions, const std::vector<HIT> &hit);
+};
+
+/**
+ * Sink writing a GFF3 file, with 1-based positions. The label, the pattern and the number of mismatches are
+ * attributes of each feature.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class Gff3Sink final : public TabularSink
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param fileName Output file name to be created, without the extension.
+     * @param patterns Pattern table used to find the state machine of each hit. It must outlive this object.
+     *
+     */
+    Gff3Sink(const std::string &fileName, const std::vector<StateMachine> &patterns);
+
+    /**
+     * Write the GFF version directive.
+     *
+     */
+    void createHeader(const std::string &commandLine);
+
+    /**
+     * Append one feature for each hit.
+     *
+     */
+    void appendGene(const std::string &geneName, const std::string &recordName, size_t offset,
+      const GeneSource &geneSource, const std::vector<PositionToMark> &positions, const std::vector<HIT> &hit);
+
+  private:
+    /**
+     * Helper to write an attribute value, escaping the GFF3 reserved characters.
+     *
+     */
+    void writeEscaped(const std::string &value);
+};
+
+/**
+ * Sink writing a flat tab separated file: sequence id, label, pattern, strand, begin, end and number of mismatches,
+ * with the same positions of the HTML summary.
+ *
+ * @author Leonardo Bispo de Oliveira.
+ *
+ */
+class TsvSink final : public TabularSink
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * @param fileName Output file name to be created, without the extension.
+     * @param patterns Pattern table used to find the state machine of each hit. It must outlive this object.
+     *
+     */
+    TsvSink(const std::string &fileName, const std::vector<StateMachine> &patterns);
+
+    /**
+     * Write the column names.
+     *
+     */
+    void createHeader(const std::string &commandLine);
+
+    /**
+     * Append one line for each hit.
+     *
+     */
+    void appendGene(const std::string &geneName, const std::string &recordName, size_t offset,
+      const GeneSource &geneSource, const std::vector<PositionToMark> &positions, const std::vector<HIT> &hit);
+};
+
+#endif
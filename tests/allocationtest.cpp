@@ -0,0 +1,152 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "hunt.h"
+
+/**
+ * Number of allocations done through operator new.
+ *
+ */
+static size_t allocations = 0;
+
+void *operator new(size_t size)
+{
+  ++allocations;
+  if (void *memory = std::malloc(size ? size : 1))
+    return memory;
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void *memory) _NOEXCEPT
+{
+  std::free(memory);
+}
+
+static
+void writeFile(const std::string &fileName, size_t records)
+{
+  std::ofstream os(fileName);
+  for (size_t record = 0; record < records; ++record) {
+    os << ">r" << record << '\n';
+
+    // ACAC... is far from all the patterns of the test, on both strands.
+    for (size_t line = 0; line < 100; ++line)
+      os << "ACACACACACACACACACACACACACACACACACACACACACACACACACACACACACAC" << '\n';
+  }
+}
+
+static
+size_t countAllocations(const HunT &hunt, const std::string &fileName)
+{
+  size_t hits = 0;
+  const size_t before = allocations;
+  hunt.execute(fileName, [&] (const std::string &, const std::string &, size_t, const GeneSource &,
+    const std::vector<PositionToMark> &, const std::vector<HIT> &) {
+    ++hits;
+  });
+
+  if (hits != 0) {
+    std::cerr << "FAILED: hits found in " << fileName << std::endl;
+    std::exit(1);
+  }
+
+  return allocations - before;
+}
+
+/**
+ * Check that matching a gene sequence without hits does not allocate memory once the scratch buffers and the records
+ * circulating between the threads were warmed up: the same search is run on files with some and with many hit-free
+ * records, and both must allocate the same. Each search is run sequentially and with threads, with and without the
+ * output queue, and on plain and packed sequences.
+ *
+ */
+int main()
+{
+  const std::string few  = "allocationtest_few.fa";
+  const std::string many = "allocationtest_many.fa";
+  writeFile(few, 100);
+  writeFile(many, 300);
+
+  struct Case
+  {
+    const char *pattern;
+    size_t      maxMismatch;
+    bool        seeded;
+  };
+
+  const Case cases[] = {
+    { "GAATTC", 0, false },
+    { "GAATTC", 1, false },
+    { "GG(AT)CC", 1, false },
+    { "TTGACANNNNNNNNNNNNNNNNNTATAAT", 2, false },
+    { "TTGACANNNNNNNNNNNNNNNNNTATAAT", 2, true },
+    { "TTGACATTGACATTGACATTGACATTGACATTGACATTGACATTGACATTGACATTGACATTGACA", 2, false }
+  };
+
+  struct Config
+  {
+    size_t threads;
+    size_t outputQueue;
+    bool   packed;
+  };
+
+  const Config configs[] = {
+    { 1, 0, false },
+    { 1, 16, false },
+    { 2, 0, false },
+    { 2, 16, false },
+    { 1, 0, true },
+    { 1, 16, true },
+    { 2, 0, true },
+    { 2, 16, true }
+  };
+
+  int ret = 0;
+  for (auto &c : cases) {
+    for (auto &config : configs) {
+      HunT hunt(c.maxMismatch);
+      hunt.addPattern("test", c.pattern, 1);
+      hunt.setSeedFilter(c.seeded);
+      hunt.setThreads(config.threads);
+      hunt.setOutputQueue(config.outputQueue);
+      hunt.setPacked(config.packed);
+
+      const size_t fewAllocations  = countAllocations(hunt, few);
+      const size_t manyAllocations = countAllocations(hunt, many);
+      if (fewAllocations != manyAllocations) {
+        std::cerr << "FAILED: " << c.pattern << " with " << c.maxMismatch << " mismatches, " << config.threads
+          << " threads, output queue " << config.outputQueue << (config.packed ? ", packed" : "") << " allocates "
+          << manyAllocations - fewAllocations << " times for 200 more records" << std::endl;
+        ret = 1;
+      }
+    }
+  }
+
+  std::remove(few.c_str());
+  std::remove(many.c_str());
+
+  if (ret == 0)
+    std::cout << "allocationtest: OK" << std::endl;
+
+  return ret;
+}
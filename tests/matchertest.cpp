@@ -0,0 +1,407 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include <iostream>
+#include <sstream>
+#include <random>
+
+#include "statemachine.h"
+#include "skipmatcher.h"
+#include "shortmatcher.h"
+#include "seedfilter.h"
+#include "motiflibrary.h"
+#include "planner.h"
+#include "hunt.h"
+
+// The motif library is parsed at compile time.
+static_assert(MotifLibrary::states("GAATTC") == 6, "Pattern of nucleotides");
+static_assert(MotifLibrary::states("A[CG]GTN(ACGT)") == 9, "Pattern with brackets and parenthesis");
+static_assert(MotifLibrary::states("ACG]") == MotifLibrary::INVALID, "Brackets closed without opening");
+
+/**
+ * Number of failed checks.
+ *
+ */
+static size_t failures = 0;
+
+static
+void check(bool condition, const std::string &what)
+{
+  if (!condition) {
+    std::cerr << "FAILED: " << what << std::endl;
+    ++failures;
+  }
+}
+
+/**
+ * Reference match, walking the states one by one as HunT does for the long state machines.
+ *
+ */
+static
+bool walk(const StateMachine &stateMachine, const std::string &sequence, size_t idx, size_t maxMismatch,
+  uint32_t &mismatches)
+{
+  StateCursor cursor(stateMachine);
+  size_t mismatchFound = 0;
+
+  mismatches = 0;
+  for (size_t idxState = idx; idxState < sequence.size(); ++idxState) {
+    const State *currentState = cursor.nextState();
+
+    if (!currentState->contains(sequence[idxState])) {
+      if (!currentState->acceptMismatch() || ++mismatchFound > maxMismatch)
+        return false;
+
+      mismatches |= 1U << (idxState - idx);
+    }
+
+    if (currentState->isFinalState())
+      return true;
+  }
+
+  return false;
+}
+
+static
+std::string randomPattern(std::mt19937 &random, size_t states)
+{
+  static const char nucleotides[] = "ACGT";
+
+  std::string pattern;
+  for (size_t state = 0; state < states; ++state) {
+    switch (random() % 8) {
+      case 0:
+        pattern += 'N';
+      break;
+      case 1:
+        pattern += '[';
+        pattern += nucleotides[random() % 4];
+        pattern += nucleotides[random() % 4];
+        pattern += ']';
+      break;
+      case 2:
+        pattern += '(';
+        pattern += nucleotides[random() % 4];
+        pattern += ')';
+      break;
+      default:
+        pattern += nucleotides[random() % 4];
+    }
+  }
+
+  return pattern;
+}
+
+static
+std::string randomSequence(std::mt19937 &random, size_t size)
+{
+  // Mostly nucleotides, with a few lower case and ambiguous characters.
+  static const char nucleotides[] = "ACGTACGTACGTACGTacgN";
+
+  std::string sequence;
+  for (size_t idx = 0; idx < size; ++idx)
+    sequence += nucleotides[random() % (sizeof(nucleotides) - 1)];
+
+  return sequence;
+}
+
+/**
+ * The skip search must find exactly the positions where the first states match without mismatches.
+ *
+ */
+static
+void testSkipMatcher(std::mt19937 &random)
+{
+  std::vector<size_t> candidates, reverseCandidates;
+  for (size_t test = 0; test < 2000; ++test) {
+    const StateMachine stateMachine("test", randomPattern(random, 1 + random() % 70), 1, '+');
+    const StateMachine reverse = stateMachine.reverseComplement();
+    const size_t       states  = std::min(stateMachine.size(), SkipMatcher::MAX_STATES);
+
+    // Short repetitive sequences make the first states match often.
+    const std::string sequence = test % 2 ? randomSequence(random, states + random() % 300) :
+      std::string(states + random() % 300, "ACGT"[random() % 4]);
+    const size_t to   = sequence.size() - states + 1;
+    const size_t from = random() % to;
+
+    std::vector<size_t> expected, reverseExpected;
+    for (size_t idx = from; idx < to; ++idx) {
+      size_t i = 0;
+      while (i < states && stateMachine.state(i).contains(sequence[idx + i]))
+        ++i;
+      if (i == states)
+        expected.push_back(idx);
+
+      for (i = 0; i < states && reverse.state(i).contains(sequence[idx + i]); ++i)
+        ;
+      if (i == states)
+        reverseExpected.push_back(idx);
+    }
+
+    candidates.clear();
+    SkipMatcher(stateMachine).search(sequence, from, to, candidates);
+    check(candidates == expected, "SkipMatcher " + stateMachine.pattern() + " on " + sequence);
+
+    candidates.clear();
+    reverseCandidates.clear();
+    SkipMatcher(stateMachine, reverse).search(sequence, from, to, candidates, reverseCandidates);
+    check(candidates == expected && reverseCandidates == reverseExpected,
+      "SkipMatcher of both strands " + stateMachine.pattern() + " on " + sequence);
+  }
+}
+
+/**
+ * The short matcher kernels must accept the same positions and report the same mismatches as the walk.
+ *
+ */
+static
+void testShortMatcher(std::mt19937 &random)
+{
+  for (size_t test = 0; test < 2000; ++test) {
+    const StateMachine stateMachine("test", randomPattern(random, 1 + random() % ShortMatcher::MAX_STATES), 1, '+');
+    const size_t       maxMismatch = random() % 5;
+    const ShortMatcher matcher(stateMachine, maxMismatch);
+
+    // Sequences close to the pattern, so there are matches with every number of mismatches.
+    std::string sequence = randomSequence(random, random() % 8);
+    for (size_t i = 0; i < stateMachine.size(); ++i)
+      sequence += random() % 4 ? "ACGT"[random() % 4] : 'N';
+    sequence += randomSequence(random, random() % 8);
+
+    for (size_t idx = 0; idx < sequence.size(); ++idx) {
+      uint32_t mismatches = 0, expectedMismatches = 0;
+      const bool matched  = matcher.match(sequence, idx, mismatches);
+      const bool expected = walk(stateMachine, sequence, idx, maxMismatch, expectedMismatches);
+
+      check(matched == expected && (!matched || mismatches == expectedMismatches),
+        "ShortMatcher " + stateMachine.pattern() + " with " + std::to_string(maxMismatch) + " mismatches at " +
+        std::to_string(idx) + " of " + sequence);
+    }
+  }
+}
+
+/**
+ * The compile time parser of the motif library must count the states of the state machine parser, and reject the
+ * same patterns.
+ *
+ */
+static
+void testMotifLibrary(std::mt19937 &random)
+{
+  for (size_t idx = 0; idx < MotifLibrary::size(); ++idx) {
+    const MotifLibrary::Motif &motif = MotifLibrary::at(idx);
+    check(motif.states == StateMachine(motif.name, motif.pattern, 1, '+').size(),
+      std::string("MotifLibrary ") + motif.name);
+  }
+
+  static const char tokens[] = "ACGTN[]()x";
+
+  for (size_t test = 0; test < 20000; ++test) {
+    std::string pattern = test % 2 ? randomPattern(random, 1 + random() % 10) : "";
+    for (size_t size = random() % 8; size > 0; --size)
+      pattern.insert(random() % (pattern.size() + 1), 1, tokens[random() % (sizeof(tokens) - 1)]);
+
+    size_t expected;
+    try {
+      expected = StateMachine("test", pattern, 1, '+').size();
+    }
+    catch (std::exception &) {
+      expected = MotifLibrary::INVALID;
+    }
+
+    check(MotifLibrary::states(pattern.c_str()) == expected, "MotifLibrary::states " + pattern);
+  }
+}
+
+/**
+ * The planner must never choose an engine that can miss matches: the skip search, which is exact, when a state can
+ * take a mismatch, or the seed filter on a state machine it cannot split in enough seeds. This holds for each strand,
+ * for both strands in the same pass, and when HunT forces the seed filter.
+ *
+ */
+static
+void testPlanner(std::mt19937 &random)
+{
+  for (size_t test = 0; test < 2000; ++test) {
+    const StateMachine stateMachine("test", randomPattern(random, 1 + random() % 70), 1, '+');
+    const StateMachine reverse     = stateMachine.reverseComplement();
+    const size_t       maxMismatch = random() % 5;
+    const Planner      planner(maxMismatch);
+
+    bool mismatches = false;
+    for (size_t i = 0; i < stateMachine.size(); ++i)
+      mismatches = mismatches || (maxMismatch > 0 && stateMachine.state(i).acceptMismatch());
+
+    const bool seedable = SeedFilter::supports(stateMachine, maxMismatch) &&
+      SeedFilter::supports(reverse, maxMismatch);
+    const std::string what = stateMachine.pattern() + " with " + std::to_string(maxMismatch) + " mismatches";
+
+    const Planner::Plan plans[] = { planner.plan(stateMachine), planner.plan(stateMachine, reverse) };
+    for (auto &plan : plans) {
+      check(!mismatches || plan.engine != Planner::Engine::SKIP, "Planner chose the skip search for " + what);
+      check(seedable || plan.engine != Planner::Engine::SEEDED, "Planner chose the seed filter for " + what);
+    }
+
+    if (test % 4 == 0) {
+      HunT hunt(maxMismatch);
+      hunt.setSeedFilter(true);
+      hunt.addPattern("test", stateMachine.pattern(), 1);
+
+      std::ostringstream out;
+      hunt.explain(out);
+      check(seedable || out.str().find("\tseeded\t") == std::string::npos,
+        "HunT forced the seed filter on " + what);
+    }
+  }
+}
+
+/**
+ * The plan shown by --explain must not change for a fixed set of patterns.
+ *
+ */
+static
+void testExplain()
+{
+  static const char expected[] =
+    "label\tstrands\tstates\tengine\tcost\n"
+    "EcoRI\t+- (palindrome)\t6\tbit-parallel\t0.38\n"
+    "box\t+-\t29\tbit-parallel\t3.63\n"
+    "exact\t+- (palindrome)\t4\tbit-parallel\t0.31\n"
+    "class\t+- (palindrome)\t6\tbit-parallel\t0.40\n"
+    "long\t+-\t66\tskip\t0.79\n"
+    "gapped\t+-\t66\tskip\t1.22\n"
+    "label\tstrands\tstates\tengine\tcost\n"
+    "EcoRI\t+- (palindrome)\t6\tbit-parallel\t0.86\n"
+    "box\t+-\t29\tseeded\t3.75\n"
+    "exact\t+- (palindrome)\t4\tseeded\t0.34\n"
+    "class\t+- (palindrome)\t6\tbit-parallel\t1.10\n"
+    "long\t+-\t66\tfilter\t4.51\n"
+    "gapped\t+-\t66\tfilter\t4.52\n"
+    "label\tstrands\tstates\tengine\tcost\n"
+    "EcoRI\t+- (palindrome)\t6\tseeded\t1.38\n"
+    "box\t+-\t29\tseeded\t3.75\n"
+    "exact\t+- (palindrome)\t4\tseeded\t0.34\n"
+    "class\t+- (palindrome)\t6\tseeded\t2.38\n"
+    "long\t+-\t66\tseeded\t8.25\n"
+    "gapped\t+-\t66\tseeded\t8.25\n";
+
+  struct Config
+  {
+    size_t maxMismatch;
+    bool   seeded;
+  };
+
+  const Config configs[] = { { 0, false }, { 1, false }, { 1, true } };
+
+  std::ostringstream out;
+  for (auto &config : configs) {
+    HunT hunt(config.maxMismatch);
+    hunt.setSeedFilter(config.seeded);
+    hunt.addPattern("EcoRI", "GAATTC", 1);
+    hunt.addPattern("box", "TTGACANNNNNNNNNNNNNNNNNTATAAT", 1);
+    hunt.addPattern("exact", "(GATC)", 1);
+    hunt.addPattern("class", "[AG]CCGG[CT]", 1);
+    hunt.addPattern("long", "TTGACATTGACATTGACATTGACATTGACATTGACATTGACATTGACATTGACATTGACATTGACA", 1);
+    hunt.addPattern("gapped", "ACGTACGTNNNNACGTACGTACGTACGTNNNNACGTACGTACGTACGTNNNNACGTACGTACGTAC", 1);
+    hunt.explain(out);
+  }
+
+  check(out.str() == expected, "HunT::explain\n" + out.str());
+}
+
+/**
+ * A pattern is palindromic only when its reverse complement has the same states, with the same classes and the same
+ * positions taking mismatches, and then both strands match the same positions with the same mismatches.
+ *
+ */
+static
+void testPalindrome(std::mt19937 &random)
+{
+  struct Case
+  {
+    const char *pattern;
+    bool        palindrome;
+  };
+
+  const Case cases[] = {
+    { "GAATTC", true },
+    { "GAATTA", false },
+    { "GANTC", true },
+    { "[AG]CCGG[CT]", true },
+    { "[AG]CCGG[AG]", false },
+    { "GC[AT]GC", true },
+    { "GC[AC]GC", false },
+    { "(GAATTC)", true },
+    { "(GA)AT(TC)", true },
+    { "(GAA)TTC", false },
+    { "G(A)ATTC", false },
+    { "(G[AG])A[CT]T(C)", false },
+    { "(G[AG])[CT](C)", false },
+    { "(G[AG])([CT]C)", true }
+  };
+
+  for (auto &c : cases)
+    check(StateMachine("test", c.pattern, 1, '+').isPalindrome() == c.palindrome,
+      std::string("StateMachine::isPalindrome ") + c.pattern);
+
+  for (size_t test = 0; test < 2000; ++test) {
+    const std::string  half    = randomPattern(random, 1 + random() % 16);
+    const std::string  pattern = test % 2 ? half + StateMachine::complement(half) : randomPattern(random, 32);
+    const StateMachine stateMachine("test", pattern, 1, '+');
+    const StateMachine reverse = stateMachine.reverseComplement();
+
+    if (test % 2) {
+      check(stateMachine.isPalindrome(), "StateMachine::isPalindrome " + pattern);
+      check(reverse.isPalindrome(), "StateMachine::isPalindrome of the reverse complement of " + pattern);
+    }
+
+    if (!stateMachine.isPalindrome())
+      continue;
+
+    const size_t      maxMismatch = random() % 3;
+    const std::string sequence    = randomSequence(random, 200);
+    for (size_t idx = 0; idx < sequence.size(); ++idx) {
+      uint32_t mismatches = 0, reverseMismatches = 0;
+      const bool matched        = walk(stateMachine, sequence, idx, maxMismatch, mismatches);
+      const bool reverseMatched = walk(reverse, sequence, idx, maxMismatch, reverseMismatches);
+
+      check(matched == reverseMatched && mismatches == reverseMismatches,
+        "Strands of the palindrome " + pattern + " at " + std::to_string(idx) + " of " + sequence);
+    }
+  }
+}
+
+/**
+ * Check the specialized matchers against the state by state walk.
+ *
+ */
+int main()
+{
+  std::mt19937 random(2013);
+
+  testSkipMatcher(random);
+  testShortMatcher(random);
+  testMotifLibrary(random);
+  testPlanner(random);
+  testExplain();
+  testPalindrome(random);
+
+  if (failures != 0)
+    return 1;
+
+  std::cout << "matchertest: OK" << std::endl;
+  return 0;
+}
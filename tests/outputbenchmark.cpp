@@ -0,0 +1,77 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+
+#include "htmlsink.h"
+
+/**
+ * Measure how fast the HTML output and summary are written. A sequence of random nucleotides, with a fixed seed, is
+ * marked with a hit every 97 nucleotides, half of them with a mismatch, and written through the HTML sink. The rate
+ * is given in MB of nucleotides written per second.
+ *
+ * Usage: outputbenchmark [megabytes] (default 64).
+ *
+ */
+int main(int argc, char **argv)
+{
+  const size_t megabytes = argc > 1 ? strtoull(argv[1], NULL, 10) : 64;
+  const size_t records   = 4;
+  const size_t size      = megabytes * (1 << 20) / records;
+  const size_t step      = 97;
+
+  std::mt19937 random(2013);
+  std::string  sequence(size, 'A');
+  for (auto &nucleotide : sequence)
+    nucleotide = "ACGT"[random() % 4];
+
+  std::vector<StateMachine> patterns;
+  patterns.push_back(StateMachine("EcoRI", "GAATTC", 1, '+'));
+
+  std::vector<PositionToMark> marks;
+  std::vector<HIT>            hit;
+  for (size_t idx = 0, count = 0; idx + 6 <= size; idx += step, ++count) {
+    marks.push_back(PositionToMark(PositionToMark::Type::BEGIN, idx, 0));
+    if (count % 2)
+      marks.push_back(PositionToMark(PositionToMark::Type::MISMATCH, idx + 2, 0));
+    marks.push_back(PositionToMark(PositionToMark::Type::END, idx + 5, 0));
+    hit.push_back(HIT(idx, idx + 5, count % 2, 0));
+  }
+
+  const auto begin = std::chrono::steady_clock::now();
+  {
+    HtmlSink sink("outputbenchmark", patterns);
+    sink.createHeader("outputbenchmark");
+    for (size_t record = 0; record < records; ++record) {
+      const std::string name = "record" + std::to_string(record);
+      sink.appendGene(name, name, 0, BufferedGeneSource(sequence), marks, hit);
+    }
+    sink.createFooter(records);
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+  std::remove("outputbenchmark.html");
+  std::remove("outputbenchmark_summary.html");
+
+  std::cout << "html: " << megabytes << " MB in " << elapsed.count() << " s, " << megabytes / elapsed.count()
+    << " MB/s" << std::endl;
+
+  return 0;
+}
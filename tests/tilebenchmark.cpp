@@ -0,0 +1,105 @@
+/* Copyright (C) 2013 Leonardo Bispo de Oliveira
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+
+#include "simdfilter.h"
+#include "packedmatcher.h"
+
+/**
+ * Tell if matching all patterns tile by tile, while the tile is in the cache, is faster than matching each pattern
+ * against the whole sequence. The filter and the packed matcher of 55 gapped patterns, with one mismatch and both
+ * strands, scan a sequence of random nucleotides with a fixed seed, first pattern by pattern and then tile by tile.
+ * The rate is given in MB of nucleotides per second, and only the scans are timed, not the verification.
+ *
+ * Usage: tilebenchmark [megabytes] [tile size] (default 64 MB and 256K nucleotides).
+ *
+ */
+int main(int argc, char **argv)
+{
+  const size_t megabytes   = argc > 1 ? strtoull(argv[1], NULL, 10) : 64;
+  const size_t tileSize    = argc > 2 ? strtoull(argv[2], NULL, 10) : 1 << 18;
+  const size_t patterns    = 55;
+  const size_t maxMismatch = 1;
+
+  std::mt19937 random(2013);
+  std::string  sequence(megabytes << 20, 'A');
+  for (auto &nucleotide : sequence)
+    nucleotide = "ACGT"[random() % 4];
+
+  // Two 6 nucleotides boxes separated by a gap of 3 to 10 N states.
+  std::vector<StateMachine>  forward, reverse;
+  std::vector<SimdFilter>    filters;
+  std::vector<PackedMatcher> packedMatchers;
+  for (size_t idx = 0; idx < patterns; ++idx) {
+    std::string pattern;
+    for (size_t i = 0; i < 6; ++i)
+      pattern += "ACGT"[random() % 4];
+    pattern += std::string(3 + random() % 8, 'N');
+    for (size_t i = 0; i < 6; ++i)
+      pattern += "ACGT"[random() % 4];
+
+    forward.push_back(StateMachine("tile", pattern, 1, '+'));
+    reverse.push_back(forward.back().reverseComplement());
+    filters.push_back(SimdFilter(forward.back(), reverse.back(), maxMismatch));
+    packedMatchers.push_back(PackedMatcher(forward.back(), reverse.back(), maxMismatch));
+  }
+
+  const GeneSequence   geneSequence(sequence);
+  const PackedSequence packedSequence(geneSequence);
+  const auto           kernel = SimdFilter::best();
+
+  std::vector<size_t> candidates, reverseCandidates;
+  size_t found = 0;
+
+  // Scan a range of starting positions with every pattern, keeping only the number of candidates found.
+  auto scan = [&] (size_t from, size_t to, bool packed) {
+    for (size_t idx = 0; idx < patterns; ++idx) {
+      const size_t last = std::min(to, sequence.size() - forward[idx].size() + 1);
+      if (from >= last)
+        continue;
+
+      candidates.clear();
+      reverseCandidates.clear();
+      if (packed)
+        packedMatchers[idx].search(packedSequence, from, last, candidates, reverseCandidates);
+      else
+        filters[idx].search(geneSequence, from, last, candidates, reverseCandidates, kernel);
+      found += candidates.size() + reverseCandidates.size();
+    }
+  };
+
+  for (int packed = 0; packed < 2; ++packed) {
+    for (int tiled = 0; tiled < 2; ++tiled) {
+      const size_t step  = tiled ? tileSize : sequence.size();
+      const auto   begin = std::chrono::steady_clock::now();
+
+      found = 0;
+      for (size_t from = 0; from < sequence.size(); from += step)
+        scan(from, std::min(from + step, sequence.size()), packed);
+
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+      std::cout << (packed ? "packed" : "filter") << (tiled ? " tiled: " : " whole: ") << megabytes << " MB in "
+        << elapsed.count() << " s, " << megabytes / elapsed.count() << " MB/s, " << found << " candidates"
+        << std::endl;
+    }
+  }
+
+  return 0;
+}